@@ -16,9 +16,19 @@ void AssetStore::ClearAssets() {
 		SDL_DestroyTexture(texture.second); // access the value, not the key
 	}
 	textures.clear();
+
+	for (auto surface : stagedSurfaces) {
+		SDL_FreeSurface(surface.second);
+	}
+	stagedSurfaces.clear();
 }
 
 void AssetStore::AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath) {
+	// Textures survive level switches, so reloading a level does not decode the same file again
+	if (textures.find(assetId) != textures.end()) {
+		return;
+	}
+
 	SDL_Surface* surface = IMG_Load(filePath.c_str());
 	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
 	SDL_FreeSurface(surface);
@@ -31,4 +41,28 @@ void AssetStore::AddTexture(SDL_Renderer* renderer, const std::string& assetId,
 
 SDL_Texture* AssetStore::GetTexture(const std::string& assetId)  {
 	return textures[assetId];
-}
\ No newline at end of file
+}
+void AssetStore::StageTexture(const std::string& assetId, const std::string& filePath) {
+	if (textures.find(assetId) != textures.end() || stagedSurfaces.find(assetId) != stagedSurfaces.end()) {
+		return;
+	}
+
+	SDL_Surface* surface = IMG_Load(filePath.c_str());
+	if (!surface) {
+		Logger::Err("Error loading image " + filePath);
+		return;
+	}
+	stagedSurfaces.emplace(assetId, surface);
+
+	Logger::Log("New texture staged in the Asset Store with id = " + assetId);
+}
+
+void AssetStore::CommitStagedTextures(SDL_Renderer* renderer) {
+	for (auto surface : stagedSurfaces) {
+		if (textures.find(surface.first) == textures.end()) {
+			textures.emplace(surface.first, SDL_CreateTextureFromSurface(renderer, surface.second));
+		}
+		SDL_FreeSurface(surface.second);
+	}
+	stagedSurfaces.clear();
+}
@@ -9,6 +9,8 @@
 class AssetStore{
 private:
 	std::map<std::string, SDL_Texture*> textures;
+	// Surfaces decoded off the main thread, waiting to be turned into textures by the renderer thread
+	std::map<std::string, SDL_Surface*> stagedSurfaces;
 	// todo - create map for fonts
 	// todo - create map for audio
 
@@ -20,6 +22,11 @@ public:
 	void AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath);
 	SDL_Texture* GetTexture(const std::string& assetId);
 
+	// Staging: StageTexture only decodes the image file, so it can run on a worker thread
+	// CommitStagedTextures must run on the thread that owns the renderer
+	void StageTexture(const std::string& assetId, const std::string& filePath);
+	void CommitStagedTextures(SDL_Renderer* renderer);
+
 };
 
 #endif
@@ -0,0 +1,30 @@
+#include "Benchmarks.h"
+#include "../Logger.h"
+
+struct Benchmark {
+	const char* name;
+	void (*run)();
+};
+
+static const Benchmark BENCHMARKS[] = {
+	{ "movement", RunMovementBenchmark },
+	{ "collision", RunCollisionBenchmark },
+	{ "broadphase", RunBroadphaseBenchmark },
+	{ "raycast", RunRaycastBenchmark },
+	{ "checksum", RunChecksumBenchmark }
+};
+
+bool RunBenchmarks(const std::string& name) {
+	bool isFound = false;
+	for (const Benchmark& benchmark : BENCHMARKS) {
+		if (name == "all" || name == benchmark.name) {
+			Logger::Log(std::string("Benchmark: ") + benchmark.name);
+			benchmark.run();
+			isFound = true;
+		}
+	}
+	if (!isFound) {
+		Logger::Err("Unknown benchmark " + name);
+	}
+	return isFound;
+}
@@ -0,0 +1,34 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <chrono>
+#include <string>
+
+//*************************************************************************************
+// BENCHMARKS
+// Performance checks of the engine's hot paths on synthetic workloads, run with
+// --benchmark <name> (or --benchmark all) instead of the game. Each benchmark builds its
+// own registry and data, needs no window, and logs its timings.
+//*************************************************************************************
+
+// Runs the benchmark with the given name, or every benchmark for "all"; false for an unknown name
+bool RunBenchmarks(const std::string& name);
+
+void RunMovementBenchmark();
+void RunCollisionBenchmark();
+void RunBroadphaseBenchmark();
+void RunRaycastBenchmark();
+void RunChecksumBenchmark();
+
+// Average time of one call of body over repetitions calls, in seconds (after one warm-up call)
+template <typename TBody>
+double MeasureSeconds(int repetitions, TBody body) {
+	body();
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < repetitions; i++) {
+		body();
+	}
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repetitions;
+}
+
+#endif
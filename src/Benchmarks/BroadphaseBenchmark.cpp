@@ -0,0 +1,105 @@
+#include "Benchmarks.h"
+#include "../Logger.h"
+#include "../Collision/SpatialHashGrid.h"
+#include "../Collision/AABBTreeBroadphase.h"
+#include "../Collision/SweepAndPrune.h"
+#include <algorithm>
+#include <memory>
+#include <cmath>
+#include <random>
+#include <vector>
+
+static const int BROADPHASE_BOXES = 20000;
+static const int BROADPHASE_STEPS = 60;
+
+// A third of the boxes are static scenery, the rest move up to 2 units a step
+struct BroadphaseScene {
+	std::vector<AABB> boxes;
+	std::vector<glm::vec2> velocities;
+	std::vector<bool> isStatic;
+};
+
+static void AddBox(BroadphaseScene& scene, std::mt19937& random, glm::vec2 position) {
+	std::uniform_real_distribution<float> size(8.0f, 32.0f);
+	std::uniform_real_distribution<float> velocity(-2.0f, 2.0f);
+	const bool isStatic = scene.boxes.size() % 3 == 0;
+	scene.boxes.push_back({ position, position + glm::vec2(size(random), size(random)) });
+	scene.velocities.push_back(isStatic ? glm::vec2(0.0f) : glm::vec2(velocity(random), velocity(random)));
+	scene.isStatic.push_back(isStatic);
+}
+
+// Boxes spread evenly, about one per 50x50 area
+static BroadphaseScene CreateUniformScene(unsigned int seed) {
+	BroadphaseScene scene;
+	std::mt19937 random(seed);
+	const float side = std::sqrt(static_cast<float>(BROADPHASE_BOXES)) * 50.0f;
+	std::uniform_real_distribution<float> position(0.0f, side);
+	for (int i = 0; i < BROADPHASE_BOXES; i++) {
+		AddBox(scene, random, glm::vec2(position(random), position(random)));
+	}
+	return scene;
+}
+
+// Dense bases amid empty jungle: nine boxes in ten sit in 16 bases of 600x600,
+// the rest are scattered over a 20000x20000 world
+static BroadphaseScene CreateClusteredScene(unsigned int seed) {
+	BroadphaseScene scene;
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> world(0.0f, 20000.0f);
+	std::uniform_real_distribution<float> base(0.0f, 600.0f);
+	std::vector<glm::vec2> bases;
+	for (int i = 0; i < 16; i++) {
+		bases.push_back(glm::vec2(world(random), world(random)));
+	}
+	for (int i = 0; i < BROADPHASE_BOXES; i++) {
+		if (i % 10 == 0) {
+			AddBox(scene, random, glm::vec2(world(random), world(random)));
+		} else {
+			AddBox(scene, random, bases[i % bases.size()] + glm::vec2(base(random), base(random)));
+		}
+	}
+	return scene;
+}
+
+// Average time of a step that moves every dynamic box and finds the pairs
+static double MeasureBroadphase(IBroadphase& broadphase, BroadphaseScene scene, size_t& pairCount) {
+	for (int i = 0; i < static_cast<int>(scene.boxes.size()); i++) {
+		broadphase.Insert(i, scene.boxes[i], scene.isStatic[i], { 1, ~0u });
+	}
+	std::vector<CollisionPair> pairs;
+	const double seconds = MeasureSeconds(BROADPHASE_STEPS, [&]() {
+		for (int i = 0; i < static_cast<int>(scene.boxes.size()); i++) {
+			if (!scene.isStatic[i]) {
+				scene.boxes[i].min += scene.velocities[i];
+				scene.boxes[i].max += scene.velocities[i];
+				broadphase.Move(i, scene.boxes[i]);
+			}
+		}
+		pairs.clear();
+		broadphase.FindPairs(pairs);
+	});
+	pairCount = pairs.size();
+	return seconds;
+}
+
+// The three broadphases on evenly spread and on clustered boxes; pair counts must agree
+void RunBroadphaseBenchmark() {
+	const BroadphaseScene scenes[] = { CreateUniformScene(1), CreateClusteredScene(2) };
+	const char* sceneNames[] = { "uniform", "clustered" };
+	for (int s = 0; s < 2; s++) {
+		SpatialHashGrid grid;
+		AABBTreeBroadphase tree;
+		SweepAndPrune sweepAndPrune;
+		size_t gridPairs = 0, treePairs = 0, sweepPairs = 0;
+		const double gridSeconds = MeasureBroadphase(grid, scenes[s], gridPairs);
+		const double treeSeconds = MeasureBroadphase(tree, scenes[s], treePairs);
+		const double sweepSeconds = MeasureBroadphase(sweepAndPrune, scenes[s], sweepPairs);
+
+		// Every box was moved once per measured step plus the warm-up step
+		const double movedBoxes = (BROADPHASE_STEPS + 1.0) * std::count(scenes[s].isStatic.begin(), scenes[s].isStatic.end(), false);
+		Logger::Log(std::to_string(BROADPHASE_BOXES) + " " + sceneNames[s] + " boxes, ms per step: spatial hash " + std::to_string(gridSeconds * 1000.0) +
+			" (" + std::to_string(gridPairs) + " pairs), AABB tree " + std::to_string(treeSeconds * 1000.0) + " (" + std::to_string(treePairs) +
+			" pairs, " + std::to_string(100.0 * tree.GetReinsertCount() / movedBoxes) + "% of moves reinserted), sweep and prune " +
+			std::to_string(sweepSeconds * 1000.0) + " (" + std::to_string(sweepPairs) + " pairs)");
+	}
+}
@@ -0,0 +1,75 @@
+#include "Benchmarks.h"
+#include "../Logger.h"
+#include "../ECS/ECS.h"
+#include "../Systems/StateChecksumSystem.h"
+#include "../Jobs/JobSystem.h"
+#include <chrono>
+#include <memory_resource>
+#include <vector>
+
+static const int CHECKSUM_ENTITIES = 100000;
+static const int CHECKSUM_REPETITIONS = 200;
+static const int CHECKSUM_JOINING_ENTITIES = 100;
+static const int CHECKSUM_JOIN_REPETITIONS = 20;
+
+// The checksum's share of a 60 Hz frame
+static const double CHECKSUM_BUDGET_SECONDS = 0.01 / 60.0;
+
+static void CreateBodies(Registry& registry, int count) {
+	for (int i = 0; i < count; i++) {
+		Entity entity = registry.CreateEntity();
+		entity.AddComponent<TransformComponent>(glm::vec2(i % 1000, i / 1000), glm::vec2(1.0, 1.0), 0.0);
+		entity.AddComponent<RigidBodyComponent>(glm::vec2(10.0, -5.0));
+		entity.AddComponent<BoxColliderComponent>(16, 16);
+	}
+	registry.Update();
+}
+
+static std::string MicrosecondsAgainstBudget(double seconds) {
+	return std::to_string(seconds * 1e6) + " us (" + std::to_string(100.0 * seconds / CHECKSUM_BUDGET_SECONDS) + "% of the budget)";
+}
+
+// StateChecksumSystem over 100k entities: a step that moves some of them, the first update that
+// hashes everything, and steps in which a few entities join
+void RunChecksumBenchmark() {
+	std::pmr::monotonic_buffer_resource memory;
+	Registry registry(&memory);
+	registry.AddSystem<StateChecksumSystem>();
+	JobSystem jobSystem;
+	CreateBodies(registry, CHECKSUM_ENTITIES);
+	auto& checksumSystem = registry.GetSystem<StateChecksumSystem>();
+	const auto& entities = checksumSystem.GetSystemEntities();
+
+	const auto rebuildStart = std::chrono::steady_clock::now();
+	checksumSystem.Update(registry, jobSystem);
+	const double rebuildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - rebuildStart).count();
+	Logger::Log(std::to_string(CHECKSUM_ENTITIES) + " entities, first update (hashes all): " + MicrosecondsAgainstBudget(rebuildSeconds));
+
+	// The awake bodies are marked before and after they move, as the game does
+	auto& transforms = registry.GetComponentPool<TransformComponent>();
+	for (int numAwake : { 1000, 5000 }) {
+		const std::vector<Entity> awakeBodies(entities.begin(), entities.begin() + numAwake);
+		const double stepSeconds = MeasureSeconds(CHECKSUM_REPETITIONS, [&]() {
+			checksumSystem.MarkChanged(awakeBodies);
+			for (const auto& entity : awakeBodies) {
+				transforms[entity.GetId()].position.x += 1.0f;
+			}
+			checksumSystem.MarkChanged(awakeBodies);
+			checksumSystem.Update(registry, jobSystem);
+		});
+		Logger::Log(std::to_string(numAwake) + " awake of " + std::to_string(CHECKSUM_ENTITIES) + " entities, per step: " + MicrosecondsAgainstBudget(stepSeconds));
+	}
+
+	// Creating entities logs each one, so only the update after they joined is timed; the first
+	// join, which grows the per-entity arrays, is the warm-up
+	double joinSeconds = 0.0;
+	CreateBodies(registry, CHECKSUM_JOINING_ENTITIES);
+	checksumSystem.Update(registry, jobSystem);
+	for (int i = 0; i < CHECKSUM_JOIN_REPETITIONS; i++) {
+		CreateBodies(registry, CHECKSUM_JOINING_ENTITIES);
+		const auto start = std::chrono::steady_clock::now();
+		checksumSystem.Update(registry, jobSystem);
+		joinSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+	Logger::Log(std::to_string(CHECKSUM_JOINING_ENTITIES) + " entities joining, per step: " + MicrosecondsAgainstBudget(joinSeconds / CHECKSUM_JOIN_REPETITIONS));
+}
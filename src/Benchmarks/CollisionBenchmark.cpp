@@ -0,0 +1,82 @@
+#include "Benchmarks.h"
+#include "../Logger.h"
+#include "../ECS/ECS.h"
+#include "../Systems/CollisionSystem.h"
+#include "../EventBus/EventBus.h"
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+static const float COLLIDER_SIZE = 16.0f;
+
+// Boxes spread evenly, about one per 40x40 area, each moving at up to 120 units a second
+static void CreateMovingColliders(Registry& registry, int count, unsigned int seed) {
+	std::mt19937 random(seed);
+	const float side = std::sqrt(static_cast<float>(count)) * 40.0f;
+	std::uniform_real_distribution<float> position(0.0f, side);
+	std::uniform_real_distribution<float> velocity(-120.0f, 120.0f);
+	for (int i = 0; i < count; i++) {
+		Entity entity = registry.CreateEntity();
+		entity.AddComponent<TransformComponent>(glm::vec2(position(random), position(random)), glm::vec2(1.0, 1.0), 0.0);
+		entity.AddComponent<RigidBodyComponent>(glm::vec2(velocity(random), velocity(random)));
+		entity.AddComponent<BoxColliderComponent>(static_cast<int>(COLLIDER_SIZE), static_cast<int>(COLLIDER_SIZE));
+	}
+	registry.Update();
+}
+
+// Advance every box by one step, as the MovementSystem would
+static void MoveColliders(Registry& registry, const std::pmr::vector<Entity>& entities, float deltaTime) {
+	auto& transforms = registry.GetComponentPool<TransformComponent>();
+	auto& rigidBodies = registry.GetComponentPool<RigidBodyComponent>();
+	for (const auto& entity : entities) {
+		auto& transform = transforms[entity.GetId()];
+		transform.previousPosition = transform.position;
+		transform.position += rigidBodies[entity.GetId()].velocity * deltaTime;
+	}
+}
+
+static size_t CountPairsNaive(Registry& registry, const std::pmr::vector<Entity>& entities) {
+	auto& transforms = registry.GetComponentPool<TransformComponent>();
+	std::vector<AABB> boxes;
+	for (const auto& entity : entities) {
+		const glm::vec2 position = transforms[entity.GetId()].position;
+		boxes.push_back({ position, position + glm::vec2(COLLIDER_SIZE) });
+	}
+	size_t count = 0;
+	for (size_t i = 0; i < boxes.size(); i++) {
+		for (size_t j = i + 1; j < boxes.size(); j++) {
+			count += Overlaps(boxes[i], boxes[j]) ? 1 : 0;
+		}
+	}
+	return count;
+}
+
+// CollisionSystem with the spatial hash against testing every pair, and the 100k moving collider step
+void RunCollisionBenchmark() {
+	for (int count : { 1000, 5000, 20000, 100000 }) {
+		std::pmr::monotonic_buffer_resource memory;
+		Registry registry(&memory);
+		registry.AddSystem<CollisionSystem>();
+		EventBus eventBus;
+		CreateMovingColliders(registry, count, 1);
+		auto& collisionSystem = registry.GetSystem<CollisionSystem>();
+		const auto& entities = collisionSystem.GetSystemEntities();
+
+		const int repetitions = count >= 100000 ? 20 : 50;
+		const double gridSeconds = MeasureSeconds(repetitions, [&]() {
+			MoveColliders(registry, entities, 1.0f / 60.0f);
+			collisionSystem.Update(registry, eventBus);
+			eventBus.Reset();
+		});
+		std::string line = std::to_string(count) + " moving colliders: spatial hash " + std::to_string(gridSeconds * 1000.0) + " ms per step (" +
+			std::to_string(collisionSystem.GetContacts().size()) + " pairs)";
+
+		// Testing every pair is only affordable for the smaller counts
+		if (count <= 20000) {
+			size_t naivePairs = 0;
+			const double naiveSeconds = MeasureSeconds(1, [&]() { naivePairs = CountPairsNaive(registry, entities); });
+			line += ", naive O(n^2) " + std::to_string(naiveSeconds * 1000.0) + " ms (" + std::to_string(naivePairs) + " pairs)";
+		}
+		Logger::Log(line);
+	}
+}
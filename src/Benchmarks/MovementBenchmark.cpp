@@ -0,0 +1,43 @@
+#include "Benchmarks.h"
+#include "../Logger.h"
+#include "../ECS/ECS.h"
+#include "../Systems/MovementSystem.h"
+#include "../Systems/MovementKernels.h"
+#include <memory_resource>
+#include <vector>
+
+static const int MOVEMENT_ENTITIES = 100000;
+static const int MOVEMENT_REPETITIONS = 200;
+
+static std::string EntitiesPerNanosecond(double seconds) {
+	return std::to_string(MOVEMENT_ENTITIES / (seconds * 1e9)) + " entities/ns (" + std::to_string(seconds * 1e6) + " us per step)";
+}
+
+// MovementSystem over 100k bodies in float and fixed point, against the SoA kernel on its own streams
+void RunMovementBenchmark() {
+	std::pmr::monotonic_buffer_resource memory;
+	Registry registry(&memory);
+	registry.AddSystem<MovementSystem>();
+	for (int i = 0; i < MOVEMENT_ENTITIES; i++) {
+		Entity entity = registry.CreateEntity();
+		entity.AddComponent<TransformComponent>(glm::vec2(i % 1000, i / 1000), glm::vec2(1.0, 1.0), 0.0);
+		entity.AddComponent<RigidBodyComponent>(glm::vec2(10.0, -5.0));
+	}
+	registry.Update();
+	auto& movementSystem = registry.GetSystem<MovementSystem>();
+	const double deltaTime = 1.0 / 60.0;
+
+	const double systemSeconds = MeasureSeconds(MOVEMENT_REPETITIONS, [&]() { movementSystem.Update(registry, deltaTime); });
+	Logger::Log("MovementSystem (float): " + EntitiesPerNanosecond(systemSeconds));
+
+	movementSystem.SetFixedPoint(true);
+	const double fixedSeconds = MeasureSeconds(MOVEMENT_REPETITIONS, [&]() { movementSystem.Update(registry, deltaTime); });
+	Logger::Log("MovementSystem (fixed point): " + EntitiesPerNanosecond(fixedSeconds));
+
+	std::vector<float> positionX(MOVEMENT_ENTITIES), positionY(MOVEMENT_ENTITIES);
+	std::vector<float> velocityX(MOVEMENT_ENTITIES, 10.0f), velocityY(MOVEMENT_ENTITIES, -5.0f);
+	const double kernelSeconds = MeasureSeconds(MOVEMENT_REPETITIONS, [&]() {
+		IntegratePositions(positionX.data(), positionY.data(), velocityX.data(), velocityY.data(), MOVEMENT_ENTITIES, static_cast<float>(deltaTime));
+	});
+	Logger::Log(std::string("IntegratePositions (") + GetIntegrateKernelName() + ", SoA streams): " + EntitiesPerNanosecond(kernelSeconds));
+}
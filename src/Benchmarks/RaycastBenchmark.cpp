@@ -0,0 +1,55 @@
+#include "Benchmarks.h"
+#include "../Logger.h"
+#include "../TileMap/TileRaycast.h"
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+static const int RAYCAST_MAP_SIZE = 1000;
+static const float RAYCAST_TILE_SIZE = 32.0f;
+static const int RAYCAST_RAYS = 200000;
+static const int RAYCAST_REPETITIONS = 5;
+
+// RaycastTilesBatch on a 1000x1000 map with one tile in twenty solid, in rays per second
+// for a growing number of threads
+void RunRaycastBenchmark() {
+	TileMap tileMap;
+	TileProperties solid;
+	solid.isSolid = true;
+	tileMap.SetTileProperties(1, solid);
+	tileMap.Create(RAYCAST_MAP_SIZE, RAYCAST_MAP_SIZE, RAYCAST_TILE_SIZE);
+	std::mt19937 random(3);
+	for (int row = 0; row < RAYCAST_MAP_SIZE; row++) {
+		for (int col = 0; col < RAYCAST_MAP_SIZE; col++) {
+			if (random() % 20 == 0) {
+				tileMap.SetTileType(col, row, 1);
+			}
+		}
+	}
+
+	// Rays from anywhere on the map in any direction, up to about 150 tiles long
+	std::uniform_real_distribution<float> position(0.0f, RAYCAST_MAP_SIZE * RAYCAST_TILE_SIZE);
+	std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+	std::vector<TileRay> rays(RAYCAST_RAYS);
+	std::vector<TileRayHit> hits(RAYCAST_RAYS);
+	for (auto& ray : rays) {
+		const float rayAngle = angle(random);
+		ray = { glm::vec2(position(random), position(random)), glm::vec2(std::cos(rayAngle), std::sin(rayAngle)), 5000.0f };
+	}
+
+	// The calling thread alone, then with 1, 3 and 7 workers; threads beyond the hardware's cannot scale
+	Logger::Log(std::to_string(std::thread::hardware_concurrency()) + " hardware threads");
+	const double singleSeconds = MeasureSeconds(RAYCAST_REPETITIONS, [&]() {
+		for (int i = 0; i < RAYCAST_RAYS; i++) {
+			hits[i] = RaycastTiles(tileMap, rays[i]);
+		}
+	});
+	Logger::Log("1 thread: " + std::to_string(RAYCAST_RAYS / singleSeconds / 1e6) + " M rays/s");
+	for (int numWorkers : { 1, 3, 7 }) {
+		JobSystem jobSystem(numWorkers);
+		const double seconds = MeasureSeconds(RAYCAST_REPETITIONS, [&]() { RaycastTilesBatch(tileMap, rays.data(), hits.data(), rays.size(), jobSystem); });
+		Logger::Log(std::to_string(jobSystem.GetNumThreads()) + " threads: " + std::to_string(RAYCAST_RAYS / seconds / 1e6) + " M rays/s (" +
+			std::to_string(singleSeconds / seconds) + "x)");
+	}
+}
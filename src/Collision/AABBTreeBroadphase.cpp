@@ -0,0 +1,143 @@
+#include "AABBTreeBroadphase.h"
+#include <algorithm>
+
+AABBTreeBroadphase::AABBTreeBroadphase(float margin): staticTree(0.0f), dynamicTree(margin) {
+}
+
+void AABBTreeBroadphase::Insert(int entityId, const AABB& box, bool isStatic, const CollisionFilter& filter) {
+	if (entityId >= static_cast<int>(proxyByEntity.size())) {
+		proxyByEntity.resize(entityId + 1, { -1, false, CollisionFilter(), AABB() });
+		dynamicIndexByEntity.resize(entityId + 1, -1);
+		isChanged.resize(entityId + 1, false);
+	}
+	if (proxyByEntity[entityId].treeProxy >= 0) {
+		Move(entityId, box);
+		return;
+	}
+
+	Proxy& proxy = proxyByEntity[entityId];
+	proxy.isStatic = isStatic;
+	proxy.filter = filter;
+	proxy.box = box;
+	if (isStatic) {
+		// Static boxes never move, so they get no margin
+		proxy.treeProxy = staticTree.CreateProxy(box, entityId);
+	} else {
+		proxy.treeProxy = dynamicTree.CreateProxy(box, entityId);
+		dynamicIndexByEntity[entityId] = static_cast<int>(dynamicEntities.size());
+		dynamicEntities.push_back(entityId);
+	}
+	MarkChanged(entityId);
+}
+
+void AABBTreeBroadphase::Remove(int entityId) {
+	if (entityId >= static_cast<int>(proxyByEntity.size()) || proxyByEntity[entityId].treeProxy < 0) {
+		return;
+	}
+
+	Proxy& proxy = proxyByEntity[entityId];
+	if (proxy.isStatic) {
+		staticTree.DestroyProxy(proxy.treeProxy);
+	} else {
+		dynamicTree.DestroyProxy(proxy.treeProxy);
+
+		// Swap the last dynamic entity into the hole
+		const int index = dynamicIndexByEntity[entityId];
+		dynamicEntities[index] = dynamicEntities.back();
+		dynamicIndexByEntity[dynamicEntities[index]] = index;
+		dynamicEntities.pop_back();
+		dynamicIndexByEntity[entityId] = -1;
+	}
+	proxy.treeProxy = -1;
+	MarkChanged(entityId);
+}
+
+void AABBTreeBroadphase::Move(int entityId, const AABB& box) {
+	Proxy& proxy = proxyByEntity[entityId];
+	const glm::vec2 displacement = box.min - proxy.box.min;
+	proxy.box = box;
+	if (!proxy.isStatic) {
+		if (dynamicTree.MoveProxy(proxy.treeProxy, box, displacement)) {
+			reinsertCount++;
+			MarkChanged(entityId);
+		}
+	}
+}
+
+void AABBTreeBroadphase::MarkChanged(int entityId) {
+	if (!isChanged[entityId]) {
+		isChanged[entityId] = true;
+		changedEntities.push_back(entityId);
+	}
+}
+
+void AABBTreeBroadphase::AddFatPair(int entityId, int otherId) {
+	if (ShouldCollide(proxyByEntity[entityId].filter, proxyByEntity[otherId].filter)) {
+		fatPairs.push_back({ std::min(entityId, otherId), std::max(entityId, otherId) });
+	}
+}
+
+void AABBTreeBroadphase::FindPairs(std::vector<CollisionPair>& pairs) {
+	// Forget every pair of a changed entity...
+	fatPairs.erase(std::remove_if(fatPairs.begin(), fatPairs.end(), [&](const CollisionPair& pair) {
+		return isChanged[pair.entityA] || isChanged[pair.entityB];
+	}), fatPairs.end());
+
+	// ...and find them again from its new fat box. A pair of two changed entities is found from
+	// both ends, so a dynamic one keeps it only from the lower id and a static one never does
+	for (const int entityId : changedEntities) {
+		const Proxy& proxy = proxyByEntity[entityId];
+		if (proxy.treeProxy < 0) {
+			continue;
+		}
+		const DynamicAABBTree& tree = proxy.isStatic ? staticTree : dynamicTree;
+		const AABB& fatBox = tree.GetFatAABB(proxy.treeProxy);
+		dynamicTree.Query(fatBox, [&](int treeProxy) {
+			const int otherId = dynamicTree.GetUserData(treeProxy);
+			if (otherId != entityId && (!isChanged[otherId] || (!proxy.isStatic && otherId > entityId))) {
+				AddFatPair(entityId, otherId);
+			}
+			return true;
+		});
+		if (!proxy.isStatic) {
+			staticTree.Query(fatBox, [&](int treeProxy) {
+				AddFatPair(entityId, staticTree.GetUserData(treeProxy));
+				return true;
+			});
+		}
+	}
+	for (const int entityId : changedEntities) {
+		isChanged[entityId] = false;
+	}
+	changedEntities.clear();
+
+	// Exact boxes lie inside the fat ones, so every overlapping pair is among the fat pairs
+	for (const CollisionPair& pair : fatPairs) {
+		if (Overlaps(proxyByEntity[pair.entityA].box, proxyByEntity[pair.entityB].box)) {
+			pairs.push_back(pair);
+		}
+	}
+}
+
+// The trees are always up to date
+void AABBTreeBroadphase::Prepare() {
+}
+
+void AABBTreeBroadphase::Query(const AABB& box, uint32_t layerMask, BroadphaseQueryCallback callback, void* context) const {
+	auto collect = [&](const DynamicAABBTree& tree) {
+		tree.Query(box, [&](int treeProxy) {
+			const int entityId = tree.GetUserData(treeProxy);
+			const Proxy& proxy = proxyByEntity[entityId];
+			if ((proxy.filter.layer & layerMask) != 0 && Overlaps(box, proxy.box)) {
+				callback(context, entityId, proxy.box);
+			}
+			return true;
+		});
+	};
+	collect(staticTree);
+	collect(dynamicTree);
+}
+
+long long AABBTreeBroadphase::GetReinsertCount() const {
+	return reinsertCount;
+}
@@ -0,0 +1,58 @@
+#ifndef AABBTREEBROADPHASE_H
+#define AABBTREEBROADPHASE_H
+
+#include "Broadphase.h"
+#include "DynamicAABBTree.h"
+#include <vector>
+
+//*************************************************************************************
+// AABB TREE BROADPHASE
+// Broadphase built on two dynamic AABB trees. Static boxes (tiles, props) go into a tree
+// of their own that is built once per level and never refit; moving boxes go into a
+// second tree that is only touched when a box leaves its fat box. Unlike the grid it has
+// no cell size to tune, so it copes with very uneven densities and box sizes.
+// Pairs whose fat boxes overlap are kept from step to step: a fat box only changes when
+// its proxy is inserted, reinserted or removed, so only those proxies are queried again,
+// and each step just tests the exact boxes of the kept pairs.
+//*************************************************************************************
+
+class AABBTreeBroadphase : public IBroadphase {
+private:
+	struct Proxy {
+		int treeProxy;		// -1 when not inserted
+		bool isStatic;
+		CollisionFilter filter;
+		AABB box;			// exact box, the trees only keep the fat one
+	};
+
+	DynamicAABBTree staticTree;
+	DynamicAABBTree dynamicTree;
+
+	std::vector<Proxy> proxyByEntity;		// [index = entity id]
+	std::vector<int> dynamicEntities;
+	std::vector<int> dynamicIndexByEntity;	// [index = entity id] position in dynamicEntities
+
+	// Pairs whose fat boxes overlap (entityA < entityB), up to date except for the changed entities
+	std::vector<CollisionPair> fatPairs;
+	std::vector<int> changedEntities;
+	std::vector<bool> isChanged;			// [index = entity id]
+	long long reinsertCount = 0;
+
+	void MarkChanged(int entityId);
+	void AddFatPair(int entityId, int otherId);
+
+public:
+	AABBTreeBroadphase(float margin = 4.0f);
+
+	void Insert(int entityId, const AABB& box, bool isStatic, const CollisionFilter& filter) override;
+	void Remove(int entityId) override;
+	void Move(int entityId, const AABB& box) override;
+	void FindPairs(std::vector<CollisionPair>& pairs) override;
+	void Prepare() override;
+	void Query(const AABB& box, uint32_t layerMask, BroadphaseQueryCallback callback, void* context) const override;
+
+	// How many moves so far left their fat box and had to be reinserted
+	long long GetReinsertCount() const;
+};
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include "../Math/Fixed.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Axis-aligned bounding box in world space
+struct AABB {
+	glm::vec2 min;
+	glm::vec2 max;
+};
+
+inline bool Overlaps(const AABB& a, const AABB& b) {
+	return a.min.x < b.max.x && a.max.x > b.min.x && a.min.y < b.max.y && a.max.y > b.min.y;
+}
+
+// Collision layers: a box sits on the layers in its layer bits and collides with the layers in its mask;
+// a pair is only tested when each box's layer is in the other's mask
+struct CollisionFilter {
+	uint32_t layer;
+	uint32_t mask;
+};
+
+inline bool ShouldCollide(const CollisionFilter& a, const CollisionFilter& b) {
+	return (a.layer & b.mask) != 0 && (b.layer & a.mask) != 0;
+}
+
+// Swept test of two moving boxes: whether a, moving by displacementA, touches b, moving by displacementB,
+// at some time in [0, 1]; timeOfImpact receives the first such time (0 when they start out overlapping)
+inline bool SweptOverlaps(const AABB& a, glm::vec2 displacementA, const AABB& b, glm::vec2 displacementB, float& timeOfImpact) {
+	// Move a relative to b, then clip the time interval on each axis (slab test)
+	const glm::vec2 displacement = displacementA - displacementB;
+	float enter = 0.0f;
+	float exit = 1.0f;
+	for (int axis = 0; axis < 2; axis++) {
+		if (displacement[axis] == 0.0f) {
+			if (a.min[axis] >= b.max[axis] || a.max[axis] <= b.min[axis]) {
+				return false;
+			}
+			continue;
+		}
+		const float inverse = 1.0f / displacement[axis];
+		float axisEnter = (b.min[axis] - a.max[axis]) * inverse;
+		float axisExit = (b.max[axis] - a.min[axis]) * inverse;
+		if (axisEnter > axisExit) {
+			std::swap(axisEnter, axisExit);
+		}
+		enter = std::max(enter, axisEnter);
+		exit = std::min(exit, axisExit);
+		if (enter >= exit) {
+			return false;
+		}
+	}
+	timeOfImpact = enter;
+	return true;
+}
+
+// SweptOverlaps computed in Q16.16 for the deterministic simulation mode; boxes and
+// displacements are rounded to 1/65536 first
+inline bool SweptOverlapsFixed(const AABB& a, glm::vec2 displacementA, const AABB& b, glm::vec2 displacementB, float& timeOfImpact) {
+	const FixedVec2 aMin(a.min), aMax(a.max), bMin(b.min), bMax(b.max);
+	const FixedVec2 displacement = FixedVec2(displacementA) - FixedVec2(displacementB);
+	Fixed enter(0);
+	Fixed exit(1);
+	for (int axis = 0; axis < 2; axis++) {
+		if (displacement[axis] == Fixed(0)) {
+			if (aMin[axis] >= bMax[axis] || aMax[axis] <= bMin[axis]) {
+				return false;
+			}
+			continue;
+		}
+		Fixed axisEnter = (bMin[axis] - aMax[axis]) / displacement[axis];
+		Fixed axisExit = (bMax[axis] - aMin[axis]) / displacement[axis];
+		if (axisEnter > axisExit) {
+			std::swap(axisEnter, axisExit);
+		}
+		enter = std::max(enter, axisEnter);
+		exit = std::min(exit, axisExit);
+		if (enter >= exit) {
+			return false;
+		}
+	}
+	timeOfImpact = enter.ToFloat();
+	return true;
+}
+
+// Two entities whose boxes overlap (entityA < entityB)
+struct CollisionPair {
+	int entityA;
+	int entityB;
+};
+
+// Called by IBroadphase::Query for every box found
+typedef void (*BroadphaseQueryCallback)(void* context, int entityId, const AABB& box);
+
+//*************************************************************************************
+// BROADPHASE
+// Finds the pairs of boxes that overlap without testing every box against every other.
+// Static boxes (scenery) never move and are never paired with each other, and pairs
+// whose collision filters reject each other are never reported.
+//*************************************************************************************
+
+class IBroadphase {
+public:
+	virtual ~IBroadphase() {}
+
+	virtual void Insert(int entityId, const AABB& box, bool isStatic, const CollisionFilter& filter) = 0;
+	virtual void Remove(int entityId) = 0;
+	virtual void Move(int entityId, const AABB& box) = 0;
+
+	// Append every overlapping pair to pairs (prepares the broadphase first)
+	virtual void FindPairs(std::vector<CollisionPair>& pairs) = 0;
+
+	// Bring the structure up to date after inserts, removals and moves, doing nothing if it already is;
+	// Query expects it to have been called. Until the next change, queries only read the structure
+	// and may run on several threads at once
+	virtual void Prepare() = 0;
+
+	// Report every entity on one of the layers in layerMask whose box overlaps the given box
+	virtual void Query(const AABB& box, uint32_t layerMask, BroadphaseQueryCallback callback, void* context) const = 0;
+};
+
+#endif
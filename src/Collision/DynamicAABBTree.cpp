@@ -0,0 +1,281 @@
+#include "DynamicAABBTree.h"
+#include <algorithm>
+
+static AABB Combine(const AABB& a, const AABB& b) {
+	return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+}
+
+static float Perimeter(const AABB& box) {
+	return 2.0f * ((box.max.x - box.min.x) + (box.max.y - box.min.y));
+}
+
+static bool Contains(const AABB& outer, const AABB& inner) {
+	return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && inner.max.x <= outer.max.x && inner.max.y <= outer.max.y;
+}
+
+DynamicAABBTree::DynamicAABBTree(float margin) {
+	this->margin = margin;
+}
+
+int DynamicAABBTree::AllocateNode() {
+	if (freeList == NULL_NODE) {
+		Node node = {};
+		node.height = -1;
+		node.parent = NULL_NODE;
+		nodes.push_back(node);
+		freeList = static_cast<int>(nodes.size()) - 1;
+	}
+
+	const int index = freeList;
+	Node& node = nodes[index];
+	freeList = node.parent;
+	node.parent = NULL_NODE;
+	node.child1 = NULL_NODE;
+	node.child2 = NULL_NODE;
+	node.height = 0;
+	node.userData = -1;
+	return index;
+}
+
+void DynamicAABBTree::FreeNode(int node) {
+	nodes[node].parent = freeList;
+	nodes[node].height = -1;
+	freeList = node;
+}
+
+int DynamicAABBTree::CreateProxy(const AABB& box, int userData) {
+	const int proxyId = AllocateNode();
+	nodes[proxyId].box = { box.min - glm::vec2(margin), box.max + glm::vec2(margin) };
+	nodes[proxyId].userData = userData;
+	InsertLeaf(proxyId);
+	return proxyId;
+}
+
+void DynamicAABBTree::DestroyProxy(int proxyId) {
+	RemoveLeaf(proxyId);
+	FreeNode(proxyId);
+}
+
+bool DynamicAABBTree::MoveProxy(int proxyId, const AABB& box, glm::vec2 displacement) {
+	if (Contains(nodes[proxyId].box, box)) {
+		return false;
+	}
+
+	RemoveLeaf(proxyId);
+	const glm::vec2 reach = DISPLACEMENT_MULTIPLIER * displacement;
+	nodes[proxyId].box = { box.min - glm::vec2(margin) + glm::min(reach, glm::vec2(0.0f)), box.max + glm::vec2(margin) + glm::max(reach, glm::vec2(0.0f)) };
+	InsertLeaf(proxyId);
+	return true;
+}
+
+const AABB& DynamicAABBTree::GetFatAABB(int proxyId) const {
+	return nodes[proxyId].box;
+}
+
+int DynamicAABBTree::GetUserData(int proxyId) const {
+	return nodes[proxyId].userData;
+}
+
+int DynamicAABBTree::GetHeight() const {
+	return root == NULL_NODE ? 0 : nodes[root].height;
+}
+
+void DynamicAABBTree::InsertLeaf(int leaf) {
+	if (root == NULL_NODE) {
+		root = leaf;
+		nodes[root].parent = NULL_NODE;
+		return;
+	}
+
+	// Walk down to the sibling whose union with the new leaf grows the tree the least
+	const AABB leafBox = nodes[leaf].box;
+	int index = root;
+	while (!nodes[index].IsLeaf()) {
+		const Node& node = nodes[index];
+		const float perimeter = Perimeter(node.box);
+		const float combinedPerimeter = Perimeter(Combine(node.box, leafBox));
+
+		// Cost of making a new parent for this node and the leaf
+		const float cost = 2.0f * combinedPerimeter;
+		// Minimum cost of pushing the leaf further down: every ancestor grows
+		const float inheritanceCost = 2.0f * (combinedPerimeter - perimeter);
+
+		float childCosts[2];
+		const int children[2] = { node.child1, node.child2 };
+		for (int c = 0; c < 2; c++) {
+			const Node& child = nodes[children[c]];
+			const float childPerimeter = Perimeter(Combine(leafBox, child.box));
+			childCosts[c] = (child.IsLeaf() ? childPerimeter : childPerimeter - Perimeter(child.box)) + inheritanceCost;
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1]) {
+			break;
+		}
+		index = (childCosts[0] < childCosts[1]) ? children[0] : children[1];
+	}
+	const int sibling = index;
+
+	// Create a new parent for the sibling and the leaf
+	const int oldParent = nodes[sibling].parent;
+	const int newParent = AllocateNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].box = Combine(leafBox, nodes[sibling].box);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].child1 = sibling;
+	nodes[newParent].child2 = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent != NULL_NODE) {
+		if (nodes[oldParent].child1 == sibling) {
+			nodes[oldParent].child1 = newParent;
+		} else {
+			nodes[oldParent].child2 = newParent;
+		}
+	} else {
+		root = newParent;
+	}
+
+	// Walk back up, rebalancing and refitting the ancestors
+	index = nodes[leaf].parent;
+	while (index != NULL_NODE) {
+		index = Balance(index);
+		Node& node = nodes[index];
+		node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+		node.box = Combine(nodes[node.child1].box, nodes[node.child2].box);
+		index = node.parent;
+	}
+}
+
+void DynamicAABBTree::RemoveLeaf(int leaf) {
+	if (leaf == root) {
+		root = NULL_NODE;
+		return;
+	}
+
+	const int parent = nodes[leaf].parent;
+	const int grandParent = nodes[parent].parent;
+	const int sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+	// The sibling takes the parent's place
+	if (grandParent == NULL_NODE) {
+		root = sibling;
+		nodes[sibling].parent = NULL_NODE;
+		FreeNode(parent);
+		return;
+	}
+
+	if (nodes[grandParent].child1 == parent) {
+		nodes[grandParent].child1 = sibling;
+	} else {
+		nodes[grandParent].child2 = sibling;
+	}
+	nodes[sibling].parent = grandParent;
+	FreeNode(parent);
+
+	int index = grandParent;
+	while (index != NULL_NODE) {
+		index = Balance(index);
+		Node& node = nodes[index];
+		node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+		node.box = Combine(nodes[node.child1].box, nodes[node.child2].box);
+		index = node.parent;
+	}
+}
+
+// Rotate the taller grandchild subtree up when the node's children differ in height by more than one
+// Returns the index of the node now at this position
+int DynamicAABBTree::Balance(int iA) {
+	Node& A = nodes[iA];
+	if (A.IsLeaf() || A.height < 2) {
+		return iA;
+	}
+
+	const int iB = A.child1;
+	const int iC = A.child2;
+	Node& B = nodes[iB];
+	Node& C = nodes[iC];
+	const int balance = C.height - B.height;
+
+	// Rotate C up
+	if (balance > 1) {
+		const int iF = C.child1;
+		const int iG = C.child2;
+		Node& F = nodes[iF];
+		Node& G = nodes[iG];
+
+		C.child1 = iA;
+		C.parent = A.parent;
+		A.parent = iC;
+		if (C.parent != NULL_NODE) {
+			if (nodes[C.parent].child1 == iA) {
+				nodes[C.parent].child1 = iC;
+			} else {
+				nodes[C.parent].child2 = iC;
+			}
+		} else {
+			root = iC;
+		}
+
+		if (F.height > G.height) {
+			C.child2 = iF;
+			A.child2 = iG;
+			G.parent = iA;
+			A.box = Combine(B.box, G.box);
+			C.box = Combine(A.box, F.box);
+			A.height = 1 + std::max(B.height, G.height);
+			C.height = 1 + std::max(A.height, F.height);
+		} else {
+			C.child2 = iG;
+			A.child2 = iF;
+			F.parent = iA;
+			A.box = Combine(B.box, F.box);
+			C.box = Combine(A.box, G.box);
+			A.height = 1 + std::max(B.height, F.height);
+			C.height = 1 + std::max(A.height, G.height);
+		}
+		return iC;
+	}
+
+	// Rotate B up
+	if (balance < -1) {
+		const int iD = B.child1;
+		const int iE = B.child2;
+		Node& D = nodes[iD];
+		Node& E = nodes[iE];
+
+		B.child1 = iA;
+		B.parent = A.parent;
+		A.parent = iB;
+		if (B.parent != NULL_NODE) {
+			if (nodes[B.parent].child1 == iA) {
+				nodes[B.parent].child1 = iB;
+			} else {
+				nodes[B.parent].child2 = iB;
+			}
+		} else {
+			root = iB;
+		}
+
+		if (D.height > E.height) {
+			B.child2 = iD;
+			A.child1 = iE;
+			E.parent = iA;
+			A.box = Combine(C.box, E.box);
+			B.box = Combine(A.box, D.box);
+			A.height = 1 + std::max(C.height, E.height);
+			B.height = 1 + std::max(A.height, D.height);
+		} else {
+			B.child2 = iE;
+			A.child1 = iD;
+			D.parent = iA;
+			A.box = Combine(C.box, D.box);
+			B.box = Combine(A.box, E.box);
+			A.height = 1 + std::max(C.height, D.height);
+			B.height = 1 + std::max(A.height, E.height);
+		}
+		return iB;
+	}
+
+	return iA;
+}
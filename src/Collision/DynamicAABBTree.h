@@ -0,0 +1,100 @@
+#ifndef DYNAMICAABBTREE_H
+#define DYNAMICAABBTREE_H
+
+#include "Broadphase.h"
+#include <vector>
+
+//*************************************************************************************
+// DYNAMIC AABB TREE
+// A binary tree of bounding boxes; every leaf holds one proxy. Leaves store a "fat" box
+// enlarged by a margin, so a proxy that moves a little stays inside it and the tree is
+// left alone. Only when a box leaves its fat box is the leaf removed and reinserted, and
+// the new fat box also reaches ahead along the proxy's last displacement, so a box
+// moving steadily is reinserted far less often than with a margin all around.
+// Insertion picks the sibling that grows the tree's perimeter the least, and every
+// node on the way back up is rebalanced with a rotation when its subtrees' heights
+// differ by more than one.
+// Nodes live in one array and are recycled through a free list.
+//*************************************************************************************
+
+class DynamicAABBTree {
+public:
+	static const int NULL_NODE = -1;
+
+	// Deeper than any tree rebalanced by rotations gets in practice (about 1.44 * log2 of the leaf count)
+	static const int QUERY_STACK_SIZE = 256;
+
+	// How many steps of its last displacement a reinserted fat box reaches ahead
+	static constexpr float DISPLACEMENT_MULTIPLIER = 16.0f;
+
+private:
+	struct Node {
+		AABB box;			// fat box for leaves, union of the children for internal nodes
+		int parent;			// next free node while the node is on the free list
+		int child1;
+		int child2;
+		int height;			// 0 for a leaf, -1 for a free node
+		int userData;
+
+		bool IsLeaf() const { return child1 == NULL_NODE; }
+	};
+
+	std::vector<Node> nodes;
+	int root = NULL_NODE;
+	int freeList = NULL_NODE;
+	float margin;
+
+	int AllocateNode();
+	void FreeNode(int node);
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	int Balance(int node);
+
+public:
+	DynamicAABBTree(float margin = 4.0f);
+
+	// Returns the proxy id of the new leaf
+	int CreateProxy(const AABB& box, int userData);
+	void DestroyProxy(int proxyId);
+
+	// Returns true when the proxy left its fat box and was reinserted; displacement is how far it moved since the last call
+	bool MoveProxy(int proxyId, const AABB& box, glm::vec2 displacement);
+
+	const AABB& GetFatAABB(int proxyId) const;
+	int GetUserData(int proxyId) const;
+	int GetHeight() const;
+
+	// Calls callback(proxyId) for every leaf whose fat box overlaps the box; stops early if it returns false
+	template <typename TCallback> void Query(const AABB& box, TCallback&& callback) const;
+};
+
+template <typename TCallback>
+void DynamicAABBTree::Query(const AABB& box, TCallback&& callback) const {
+	if (root == NULL_NODE) {
+		return;
+	}
+
+	// The balanced tree stays shallow, so a small stack on the thread's own stack is enough;
+	// keeping it local lets several threads query the same tree
+	int stack[QUERY_STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = root;
+	while (stackSize > 0) {
+		const int index = stack[--stackSize];
+
+		const Node& node = nodes[index];
+		if (!Overlaps(node.box, box)) {
+			continue;
+		}
+		if (node.IsLeaf()) {
+			if (!callback(index)) {
+				return;
+			}
+		} else if (stackSize + 2 <= QUERY_STACK_SIZE) {
+			stack[stackSize++] = node.child1;
+			stack[stackSize++] = node.child2;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,290 @@
+#include "SpatialHashGrid.h"
+#include <algorithm>
+#include <cmath>
+
+// Cell size until the first rebuild sees any boxes
+static const float DEFAULT_CELL_SIZE = 100.0f;
+
+// Automatic cell size as a multiple of the average box extent. Twice the extent puts
+// most boxes in two to four cells; four times keeps most in one for a few more tests
+static const float CELL_SIZE_PER_EXTENT = 4.0f;
+
+SpatialHashGrid::SpatialHashGrid(float cellSize) {
+	this->isCellSizeFixed = cellSize > 0.0f;
+	this->cellSize = isCellSizeFixed ? cellSize : DEFAULT_CELL_SIZE;
+	this->inverseCellSize = 1.0f / this->cellSize;
+}
+
+int SpatialHashGrid::ToCell(float coordinate) const {
+	// Truncation rounds towards zero; step down for negative coordinates to get the floor
+	const float scaled = coordinate * inverseCellSize;
+	const int cell = static_cast<int>(scaled);
+	return (scaled < cell) ? cell - 1 : cell;
+}
+
+unsigned int SpatialHashGrid::HashCell(int cellX, int cellY) const {
+	return ((static_cast<unsigned int>(cellX) * 73856093u) ^ (static_cast<unsigned int>(cellY) * 19349663u)) & bucketMask;
+}
+
+void SpatialHashGrid::SetCells(Proxy& proxy) const {
+	proxy.cellX0 = ToCell(proxy.box.min.x);
+	proxy.cellY0 = ToCell(proxy.box.min.y);
+	proxy.cellX1 = ToCell(proxy.box.max.x);
+	proxy.cellY1 = ToCell(proxy.box.max.y);
+}
+
+bool SpatialHashGrid::HasSameCells(const Proxy& a, const Proxy& b) {
+	return a.cellX0 == b.cellX0 && a.cellY0 == b.cellY0 && a.cellX1 == b.cellX1 && a.cellY1 == b.cellY1;
+}
+
+void SpatialHashGrid::Insert(int entityId, const AABB& box, bool isStatic, const CollisionFilter& filter) {
+	if (entityId >= static_cast<int>(proxyIndexByEntity.size())) {
+		proxyIndexByEntity.resize(entityId + 1, -1);
+	}
+	if (proxyIndexByEntity[entityId] >= 0) {
+		Move(entityId, box);
+		return;
+	}
+	proxyIndexByEntity[entityId] = static_cast<int>(proxies.size());
+	proxies.push_back({ entityId, isStatic, false, filter, box, 0, 0, -1, -1 });
+	isGridDirty = true;
+}
+
+void SpatialHashGrid::Remove(int entityId) {
+	if (entityId >= static_cast<int>(proxyIndexByEntity.size()) || proxyIndexByEntity[entityId] < 0) {
+		return;
+	}
+
+	// Swap the last proxy into the hole to keep the array dense
+	const int index = proxyIndexByEntity[entityId];
+	proxies[index] = proxies.back();
+	proxyIndexByEntity[proxies[index].entityId] = index;
+	proxies.pop_back();
+	proxyIndexByEntity[entityId] = -1;
+	isGridDirty = true;
+}
+
+void SpatialHashGrid::Move(int entityId, const AABB& box) {
+	const int proxyIndex = proxyIndexByEntity[entityId];
+	Proxy& proxy = proxies[proxyIndex];
+	proxy.box = box;
+	if (!isGridDirty && !proxy.isMoved) {
+		proxy.isMoved = true;
+		movedProxies.push_back(proxyIndex);
+	}
+}
+
+int SpatialHashGrid::FindEntry(int cellX, int cellY, int proxyIndex) const {
+	const unsigned int bucket = HashCell(cellX, cellY);
+	const int end = bucketStart[bucket] + bucketSize[bucket];
+	for (int i = bucketStart[bucket]; i < end; i++) {
+		const CellEntry& entry = entries[i];
+		if (entry.proxyIndex == proxyIndex && entry.cellX == static_cast<int16_t>(cellX) && entry.cellY == static_cast<int16_t>(cellY)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// A full bucket moves to the end of the array with twice the room
+void SpatialHashGrid::AddEntry(int cellX, int cellY, int proxyIndex) {
+	const unsigned int bucket = HashCell(cellX, cellY);
+	if (bucketSize[bucket] == bucketCapacity[bucket]) {
+		const int start = static_cast<int>(entries.size());
+		const int capacity = std::max(2 * bucketCapacity[bucket], 4);
+		entries.resize(entries.size() + capacity);
+		std::copy(entries.begin() + bucketStart[bucket], entries.begin() + bucketStart[bucket] + bucketSize[bucket], entries.begin() + start);
+		bucketStart[bucket] = start;
+		bucketCapacity[bucket] = capacity;
+	}
+	entries[bucketStart[bucket] + bucketSize[bucket]++] = { proxies[proxyIndex].box, static_cast<int16_t>(cellX), static_cast<int16_t>(cellY), proxyIndex };
+}
+
+// The bucket's last entry fills the hole
+void SpatialHashGrid::RemoveEntry(int cellX, int cellY, int proxyIndex) {
+	const unsigned int bucket = HashCell(cellX, cellY);
+	const int last = bucketStart[bucket] + bucketSize[bucket] - 1;
+	entries[FindEntry(cellX, cellY, proxyIndex)] = entries[last];
+	bucketSize[bucket]--;
+}
+
+// A box that stayed in its cells rewrites its entries; one that crossed into other cells moves them
+void SpatialHashGrid::UpdateMovedProxy(int proxyIndex) {
+	Proxy& proxy = proxies[proxyIndex];
+	proxy.isMoved = false;
+	const Proxy previous = proxy;
+	SetCells(proxy);
+	if (HasSameCells(proxy, previous)) {
+		for (int y = proxy.cellY0; y <= proxy.cellY1; y++) {
+			for (int x = proxy.cellX0; x <= proxy.cellX1; x++) {
+				entries[FindEntry(x, y, proxyIndex)].box = proxy.box;
+			}
+		}
+		return;
+	}
+	for (int y = previous.cellY0; y <= previous.cellY1; y++) {
+		for (int x = previous.cellX0; x <= previous.cellX1; x++) {
+			RemoveEntry(x, y, proxyIndex);
+		}
+	}
+	for (int y = proxy.cellY0; y <= proxy.cellY1; y++) {
+		for (int x = proxy.cellX0; x <= proxy.cellX1; x++) {
+			AddEntry(x, y, proxyIndex);
+		}
+	}
+}
+
+// Adds delta to the entry count of every bucket the proxy's cells hash to
+void SpatialHashGrid::CountEntries(const Proxy& proxy, int delta) {
+	for (int y = proxy.cellY0; y <= proxy.cellY1; y++) {
+		for (int x = proxy.cellX0; x <= proxy.cellX1; x++) {
+			bucketSize[HashCell(x, y)] += delta;
+		}
+	}
+}
+
+// Counting sort of all entries by bucket. The counts are kept from the last update, so
+// unless boxes were inserted or removed only movers that changed cells are recounted
+void SpatialHashGrid::RebuildGrid() {
+	if (isGridDirty) {
+		if (!isCellSizeFixed && !proxies.empty()) {
+			double extentSum = 0.0;
+			for (const auto& proxy : proxies) {
+				extentSum += std::max(proxy.box.max.x - proxy.box.min.x, proxy.box.max.y - proxy.box.min.y);
+			}
+			cellSize = std::max(CELL_SIZE_PER_EXTENT * static_cast<float>(extentSum / proxies.size()), 1.0f);
+			inverseCellSize = 1.0f / cellSize;
+		}
+
+		// About one bucket per box (rounded up to a power of two)
+		unsigned int bucketCount = 64;
+		while (bucketCount < proxies.size()) {
+			bucketCount *= 2;
+		}
+		bucketMask = bucketCount - 1;
+
+		bucketSize.assign(bucketCount, 0);
+		for (auto& proxy : proxies) {
+			proxy.isMoved = false;
+			SetCells(proxy);
+			CountEntries(proxy, 1);
+		}
+	} else {
+		for (const int proxyIndex : movedProxies) {
+			Proxy& proxy = proxies[proxyIndex];
+			proxy.isMoved = false;
+			const Proxy previous = proxy;
+			SetCells(proxy);
+			if (!HasSameCells(proxy, previous)) {
+				CountEntries(previous, -1);
+				CountEntries(proxy, 1);
+			}
+		}
+	}
+	movedProxies.clear();
+
+	const unsigned int bucketCount = bucketMask + 1;
+	bucketStart.resize(bucketCount);
+	bucketCapacity.resize(bucketCount);
+	int start = 0;
+	for (unsigned int bucket = 0; bucket < bucketCount; bucket++) {
+		bucketStart[bucket] = start;
+		bucketCapacity[bucket] = bucketSize[bucket];
+		start += bucketSize[bucket];
+		bucketSize[bucket] = 0;
+	}
+
+	// Write every entry straight into its bucket's slot
+	entries.resize(start);
+	for (int proxyIndex = 0; proxyIndex < static_cast<int>(proxies.size()); proxyIndex++) {
+		const Proxy& proxy = proxies[proxyIndex];
+		for (int y = proxy.cellY0; y <= proxy.cellY1; y++) {
+			for (int x = proxy.cellX0; x <= proxy.cellX1; x++) {
+				const unsigned int bucket = HashCell(x, y);
+				entries[bucketStart[bucket] + bucketSize[bucket]++] = { proxy.box, static_cast<int16_t>(x), static_cast<int16_t>(y), proxyIndex };
+			}
+		}
+	}
+
+	builtEntryCount = entries.size();
+	isGridDirty = false;
+}
+
+void SpatialHashGrid::UpdateGrid() {
+	if (isGridDirty || movedProxies.size() > proxies.size() / REBUILD_MOVER_FRACTION) {
+		RebuildGrid();
+		return;
+	}
+	for (const int proxyIndex : movedProxies) {
+		UpdateMovedProxy(proxyIndex);
+	}
+	movedProxies.clear();
+
+	// Buckets that moved leave their old room behind; once it adds up to the grid's size, compact
+	if (entries.size() > 2 * builtEntryCount) {
+		RebuildGrid();
+	}
+}
+
+// Two boxes can share several cells; a pair is only reported from the first cell they share
+bool SpatialHashGrid::IsFirstSharedCell(const CellEntry& entry, const AABB& a, const AABB& b) const {
+	return entry.cellX == static_cast<int16_t>(std::max(ToCell(a.min.x), ToCell(b.min.x))) &&
+		entry.cellY == static_cast<int16_t>(std::max(ToCell(a.min.y), ToCell(b.min.y)));
+}
+
+void SpatialHashGrid::FindPairs(std::vector<CollisionPair>& pairs) {
+	UpdateGrid();
+
+	const int bucketCount = static_cast<int>(bucketMask) + 1;
+	for (int bucket = 0; bucket < bucketCount; bucket++) {
+		const int end = bucketStart[bucket] + bucketSize[bucket];
+		for (int i = bucketStart[bucket]; i < end; i++) {
+			const CellEntry& a = entries[i];
+			for (int j = i + 1; j < end; j++) {
+				const CellEntry& b = entries[j];
+				// Different cells can share a bucket; the tests are combined without branches, as nearly all fail
+				const bool isCandidate = (a.cellX == b.cellX) & (a.cellY == b.cellY) &
+					(a.box.min.x < b.box.max.x) & (a.box.max.x > b.box.min.x) & (a.box.min.y < b.box.max.y) & (a.box.max.y > b.box.min.y);
+				if (!isCandidate || !IsFirstSharedCell(a, a.box, b.box)) {
+					continue;
+				}
+				const Proxy& proxyA = proxies[a.proxyIndex];
+				const Proxy& proxyB = proxies[b.proxyIndex];
+				if ((proxyA.isStatic && proxyB.isStatic) || !ShouldCollide(proxyA.filter, proxyB.filter)) {
+					continue;
+				}
+				pairs.push_back({ std::min(proxyA.entityId, proxyB.entityId), std::max(proxyA.entityId, proxyB.entityId) });
+			}
+		}
+	}
+}
+
+void SpatialHashGrid::Prepare() {
+	UpdateGrid();
+}
+
+void SpatialHashGrid::Query(const AABB& box, uint32_t layerMask, BroadphaseQueryCallback callback, void* context) const {
+	const int x0 = ToCell(box.min.x), x1 = ToCell(box.max.x);
+	const int y0 = ToCell(box.min.y), y1 = ToCell(box.max.y);
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) {
+			const unsigned int bucket = HashCell(x, y);
+			const int end = bucketStart[bucket] + bucketSize[bucket];
+			for (int i = bucketStart[bucket]; i < end; i++) {
+				const CellEntry& entry = entries[i];
+				if (entry.cellX != static_cast<int16_t>(x) || entry.cellY != static_cast<int16_t>(y) || !Overlaps(box, entry.box)) {
+					continue;
+				}
+				const Proxy& proxy = proxies[entry.proxyIndex];
+				if ((proxy.filter.layer & layerMask) == 0) {
+					continue;
+				}
+				// Report each box once, from the first cell it shares with the query
+				if (x != std::max(x0, proxy.cellX0) || y != std::max(y0, proxy.cellY0)) {
+					continue;
+				}
+				callback(context, proxy.entityId, entry.box);
+			}
+		}
+	}
+}
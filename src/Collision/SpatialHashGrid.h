@@ -0,0 +1,88 @@
+#ifndef SPATIALHASHGRID_H
+#define SPATIALHASHGRID_H
+
+#include "Broadphase.h"
+#include <cstdint>
+#include <vector>
+
+//*************************************************************************************
+// SPATIAL HASH GRID
+// Uniform grid broadphase. Space is split into square cells that are hashed into a
+// fixed number of buckets; every box is entered into each cell it touches. All entries
+// sit in one contiguous array, grouped by bucket, so nothing is allocated once warmed up.
+// Boxes that moved are brought up to date when the grid is next queried: a few movers
+// have just their own entries updated (a bucket that runs out of room moves to the end
+// of the array), while inserts, removals or many movers rebuild the whole grid with a
+// two-pass counting sort, which is cheaper than updating most entries one by one.
+// Unless a cell size is given, every rebuild sizes the cells from the average box extent,
+// so most boxes touch one cell and a bucket holds only a few of them.
+//*************************************************************************************
+
+class SpatialHashGrid : public IBroadphase {
+private:
+	struct Proxy {
+		int entityId;
+		bool isStatic;
+		bool isMoved;			// moved since the grid was last brought up to date
+		CollisionFilter filter;
+		AABB box;
+		int cellX0, cellY0, cellX1, cellY1;		// cells the box is entered in
+	};
+
+	// A copy of the box travels with each entry so pair tests read the entry array sequentially;
+	// the rest of the proxy is only looked up for boxes that overlap. Cell coordinates are
+	// kept in 16 bits: they only tell apart cells that share a bucket and pick the cell a
+	// pair is reported from, and boxes that overlap are never 65536 cells apart
+	struct CellEntry {
+		AABB box;
+		int16_t cellX;
+		int16_t cellY;
+		int proxyIndex;
+	};
+
+	// Above one mover in this many boxes, the grid is rebuilt rather than updated box by box
+	static const size_t REBUILD_MOVER_FRACTION = 4;
+
+	float cellSize;
+	float inverseCellSize;
+	bool isCellSizeFixed;
+
+	std::vector<Proxy> proxies;
+	std::vector<int> proxyIndexByEntity;	// [index = entity id], -1 when not inserted
+	std::vector<int> movedProxies;
+
+	// Bucket b holds entries[bucketStart[b] .. bucketStart[b] + bucketSize[b]), with room for bucketCapacity[b]
+	std::vector<CellEntry> entries;
+	std::vector<int> bucketStart;
+	std::vector<int> bucketSize;
+	std::vector<int> bucketCapacity;
+	size_t builtEntryCount = 0;			// size of the entry array after the last rebuild
+	unsigned int bucketMask = 0;
+	bool isGridDirty = true;
+
+	int ToCell(float coordinate) const;
+	unsigned int HashCell(int cellX, int cellY) const;
+	void SetCells(Proxy& proxy) const;
+	static bool HasSameCells(const Proxy& a, const Proxy& b);
+	int FindEntry(int cellX, int cellY, int proxyIndex) const;
+	void AddEntry(int cellX, int cellY, int proxyIndex);
+	void RemoveEntry(int cellX, int cellY, int proxyIndex);
+	void CountEntries(const Proxy& proxy, int delta);
+	void UpdateMovedProxy(int proxyIndex);
+	void RebuildGrid();
+	void UpdateGrid();
+	bool IsFirstSharedCell(const CellEntry& entry, const AABB& a, const AABB& b) const;
+
+public:
+	// A cell size of 0 sizes the cells from the boxes
+	SpatialHashGrid(float cellSize = 0.0f);
+
+	void Insert(int entityId, const AABB& box, bool isStatic, const CollisionFilter& filter) override;
+	void Remove(int entityId) override;
+	void Move(int entityId, const AABB& box) override;
+	void FindPairs(std::vector<CollisionPair>& pairs) override;
+	void Prepare() override;
+	void Query(const AABB& box, uint32_t layerMask, BroadphaseQueryCallback callback, void* context) const override;
+};
+
+#endif
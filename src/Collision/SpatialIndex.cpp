@@ -0,0 +1,129 @@
+#include "SpatialIndex.h"
+#include <algorithm>
+
+// Radius of the first search ring of a k-nearest query; it doubles until k entities are found
+static const float K_NEAREST_START_RADIUS = 64.0f;
+
+// Queries per job in a batch
+static const size_t QUERY_BATCH_SIZE = 64;
+
+static float DistanceSquared(glm::vec2 point, const AABB& box) {
+	const glm::vec2 outside = glm::max(glm::max(box.min - point, point - box.max), glm::vec2(0.0f));
+	return glm::dot(outside, outside);
+}
+
+void SpatialIndex::SetBroadphase(IBroadphase* broadphase) {
+	this->broadphase = broadphase;
+}
+
+namespace {
+	struct CollectContext {
+		glm::vec2 point;
+		float radiusSquared;
+		SpatialQueryHit* hits;
+		int capacity;
+		int count;
+	};
+
+	void CollectInRect(void* context, int entityId, const AABB&) {
+		CollectContext& collect = *static_cast<CollectContext*>(context);
+		if (collect.count < collect.capacity) {
+			collect.hits[collect.count] = { entityId, 0.0f };
+		}
+		collect.count++;
+	}
+
+	void CollectInRadius(void* context, int entityId, const AABB& box) {
+		CollectContext& collect = *static_cast<CollectContext*>(context);
+		const float distanceSquared = DistanceSquared(collect.point, box);
+		if (distanceSquared > collect.radiusSquared) {
+			return;
+		}
+		if (collect.count < collect.capacity) {
+			collect.hits[collect.count] = { entityId, distanceSquared };
+		}
+		collect.count++;
+	}
+
+	bool IsNearer(const SpatialQueryHit& a, const SpatialQueryHit& b) {
+		return a.distanceSquared < b.distanceSquared;
+	}
+
+	// Keeps the k nearest in a max-heap on distance, so the farthest kept hit is always hits[0]
+	void CollectNearest(void* context, int entityId, const AABB& box) {
+		CollectContext& collect = *static_cast<CollectContext*>(context);
+		const float distanceSquared = DistanceSquared(collect.point, box);
+		if (distanceSquared > collect.radiusSquared) {
+			return;
+		}
+		if (collect.count < collect.capacity) {
+			collect.hits[collect.count++] = { entityId, distanceSquared };
+			std::push_heap(collect.hits, collect.hits + collect.count, IsNearer);
+		} else if (distanceSquared < collect.hits[0].distanceSquared) {
+			std::pop_heap(collect.hits, collect.hits + collect.count, IsNearer);
+			collect.hits[collect.count - 1] = { entityId, distanceSquared };
+			std::push_heap(collect.hits, collect.hits + collect.count, IsNearer);
+		}
+	}
+}
+
+int SpatialIndex::QueryRect(const AABB& rect, uint32_t layerMask, SpatialQueryHit* hits, int capacity) const {
+	CollectContext collect = { glm::vec2(0.0f), 0.0f, hits, capacity, 0 };
+	broadphase->Prepare();
+	broadphase->Query(rect, layerMask, CollectInRect, &collect);
+	return collect.count;
+}
+
+int SpatialIndex::QueryRadius(glm::vec2 point, float radius, uint32_t layerMask, SpatialQueryHit* hits, int capacity) const {
+	CollectContext collect = { point, radius * radius, hits, capacity, 0 };
+	broadphase->Prepare();
+	broadphase->Query({ point - glm::vec2(radius), point + glm::vec2(radius) }, layerMask, CollectInRadius, &collect);
+	return collect.count;
+}
+
+int SpatialIndex::QueryKNearest(glm::vec2 point, int k, float maxRadius, uint32_t layerMask, SpatialQueryHit* hits) const {
+	if (k <= 0) {
+		return 0;
+	}
+
+	// Search growing rings: everything within the current radius is found, so once k hits are in, they are the k nearest
+	CollectContext collect = { point, 0.0f, hits, k, 0 };
+	broadphase->Prepare();
+	float radius = std::min(K_NEAREST_START_RADIUS, maxRadius);
+	while (true) {
+		collect.radiusSquared = radius * radius;
+		collect.count = 0;
+		broadphase->Query({ point - glm::vec2(radius), point + glm::vec2(radius) }, layerMask, CollectNearest, &collect);
+		if (collect.count == k || radius >= maxRadius) {
+			break;
+		}
+		radius = std::min(radius * 2.0f, maxRadius);
+	}
+
+	std::sort_heap(hits, hits + collect.count, IsNearer);
+	return collect.count;
+}
+
+void SpatialIndex::Query(SpatialQuery& query) const {
+	switch (query.type) {
+		case SPATIAL_QUERY_RECT:
+			query.hitCount = std::min(QueryRect(query.rect, query.layerMask, query.hits, query.capacity), query.capacity);
+			break;
+		case SPATIAL_QUERY_RADIUS:
+			query.hitCount = std::min(QueryRadius(query.point, query.radius, query.layerMask, query.hits, query.capacity), query.capacity);
+			break;
+		case SPATIAL_QUERY_K_NEAREST:
+			query.hitCount = QueryKNearest(query.point, query.capacity, query.radius, query.layerMask, query.hits);
+			break;
+	}
+}
+
+void SpatialIndex::QueryBatch(SpatialQuery* queries, size_t count, JobSystem& jobSystem) const {
+	// Prepared here, the Prepare in each query below finds nothing to do and only reads
+	broadphase->Prepare();
+	jobSystem.ParallelFor(count, QUERY_BATCH_SIZE, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			Query(queries[i]);
+		}
+	});
+}
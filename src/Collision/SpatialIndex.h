@@ -0,0 +1,62 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include "Broadphase.h"
+#include "../Jobs/JobSystem.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+struct SpatialQueryHit {
+	int entityId;
+	float distanceSquared;		// from the query point to the nearest point of the entity's box
+};
+
+enum SpatialQueryType {
+	SPATIAL_QUERY_RECT,
+	SPATIAL_QUERY_RADIUS,
+	SPATIAL_QUERY_K_NEAREST
+};
+
+// One query of a batch: the inputs its type uses, the caller's result buffer and the result count
+struct SpatialQuery {
+	SpatialQueryType type;
+	AABB rect;					// SPATIAL_QUERY_RECT
+	glm::vec2 point;			// SPATIAL_QUERY_RADIUS and SPATIAL_QUERY_K_NEAREST
+	float radius;				// search radius; the largest one searched for SPATIAL_QUERY_K_NEAREST
+	uint32_t layerMask;
+	SpatialQueryHit* hits;		// capacity hits; for SPATIAL_QUERY_K_NEAREST the capacity is k
+	int capacity;
+	int hitCount;				// written by the query
+};
+
+//*************************************************************************************
+// SPATIAL INDEX
+// "Who is near X" queries on top of a broadphase, so gameplay code searches the same
+// structure the collision system keeps up to date instead of scanning every entity.
+// Results go into buffers the caller provides and nothing is allocated. Each query first
+// prepares the broadphase if it changed since the last one; a batch prepares it once up
+// front, after which its queries only read it and are spread over the job system's threads.
+//*************************************************************************************
+
+class SpatialIndex {
+private:
+	IBroadphase* broadphase = nullptr;
+
+public:
+	SpatialIndex() = default;
+
+	void SetBroadphase(IBroadphase* broadphase);
+
+	// Each query returns the number of entities found, which can exceed the capacity; only the first capacity are written
+	int QueryRect(const AABB& rect, uint32_t layerMask, SpatialQueryHit* hits, int capacity) const;
+	int QueryRadius(glm::vec2 point, float radius, uint32_t layerMask, SpatialQueryHit* hits, int capacity) const;
+
+	// Up to k entities within maxRadius of the point, nearest first; returns how many were found
+	int QueryKNearest(glm::vec2 point, int k, float maxRadius, uint32_t layerMask, SpatialQueryHit* hits) const;
+
+	void Query(SpatialQuery& query) const;
+	void QueryBatch(SpatialQuery* queries, size_t count, JobSystem& jobSystem) const;
+};
+
+#endif
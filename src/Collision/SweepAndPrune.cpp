@@ -0,0 +1,245 @@
+#include "SweepAndPrune.h"
+#include <algorithm>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SWEEP_AND_PRUNE_SSE
+#include <emmintrin.h>
+#endif
+
+SweepAndPrune::SweepAndPrune() {
+	WriteSentinels();
+}
+
+void SweepAndPrune::WriteSentinels() {
+	const float infinity = std::numeric_limits<float>::infinity();
+	minX.resize(count + SIMD_PADDING);
+	maxX.resize(count + SIMD_PADDING);
+	minY.resize(count + SIMD_PADDING);
+	maxY.resize(count + SIMD_PADDING);
+	entityIds.resize(count + SIMD_PADDING);
+	staticMasks.resize(count + SIMD_PADDING);
+	layers.resize(count + SIMD_PADDING);
+	masks.resize(count + SIMD_PADDING);
+	for (int i = count; i < count + SIMD_PADDING; i++) {
+		minX[i] = infinity;
+		maxX[i] = infinity;
+		minY[i] = infinity;
+		maxY[i] = infinity;
+		entityIds[i] = -1;
+		staticMasks[i] = -1;
+		layers[i] = 0;
+		masks[i] = 0;
+	}
+}
+
+void SweepAndPrune::Insert(int entityId, const AABB& box, bool isStatic, const CollisionFilter& filter) {
+	if (entityId >= static_cast<int>(indexByEntity.size())) {
+		indexByEntity.resize(entityId + 1, -1);
+	}
+	if (indexByEntity[entityId] >= 0) {
+		Move(entityId, box);
+		return;
+	}
+
+	// Append over the first sentinel; the sort moves it into place
+	const int index = count++;
+	WriteSentinels();
+	minX[index] = box.min.x;
+	maxX[index] = box.max.x;
+	minY[index] = box.min.y;
+	maxY[index] = box.max.y;
+	entityIds[index] = entityId;
+	staticMasks[index] = isStatic ? -1 : 0;
+	layers[index] = filter.layer;
+	masks[index] = filter.mask;
+	indexByEntity[entityId] = index;
+	insertedSinceSort++;
+	isSortDirty = true;
+}
+
+void SweepAndPrune::Remove(int entityId) {
+	if (entityId >= static_cast<int>(indexByEntity.size()) || indexByEntity[entityId] < 0) {
+		return;
+	}
+
+	// Leave a hole that the next sort compacts, so removal keeps the order
+	entityIds[indexByEntity[entityId]] = -1;
+	indexByEntity[entityId] = -1;
+	isSortDirty = true;
+}
+
+void SweepAndPrune::Move(int entityId, const AABB& box) {
+	const int index = indexByEntity[entityId];
+	minX[index] = box.min.x;
+	maxX[index] = box.max.x;
+	minY[index] = box.min.y;
+	maxY[index] = box.max.y;
+	isSortDirty = true;
+}
+
+void SweepAndPrune::Compact() {
+	int write = 0;
+	for (int read = 0; read < count; read++) {
+		if (entityIds[read] < 0) {
+			continue;
+		}
+		minX[write] = minX[read];
+		maxX[write] = maxX[read];
+		minY[write] = minY[read];
+		maxY[write] = maxY[read];
+		entityIds[write] = entityIds[read];
+		staticMasks[write] = staticMasks[read];
+		layers[write] = layers[read];
+		masks[write] = masks[read];
+		write++;
+	}
+	count = write;
+}
+
+void SweepAndPrune::InsertionSort() {
+	for (int i = 1; i < count; i++) {
+		const float key = minX[i];
+		if (minX[i - 1] <= key) {
+			continue;
+		}
+
+		const float keyMaxX = maxX[i], keyMinY = minY[i], keyMaxY = maxY[i];
+		const int keyEntity = entityIds[i], keyStatic = staticMasks[i];
+		const uint32_t keyLayer = layers[i], keyMask = masks[i];
+		int j = i;
+		for (; j > 0 && minX[j - 1] > key; j--) {
+			minX[j] = minX[j - 1];
+			maxX[j] = maxX[j - 1];
+			minY[j] = minY[j - 1];
+			maxY[j] = maxY[j - 1];
+			entityIds[j] = entityIds[j - 1];
+			staticMasks[j] = staticMasks[j - 1];
+			layers[j] = layers[j - 1];
+			masks[j] = masks[j - 1];
+		}
+		minX[j] = key;
+		maxX[j] = keyMaxX;
+		minY[j] = keyMinY;
+		maxY[j] = keyMaxY;
+		entityIds[j] = keyEntity;
+		staticMasks[j] = keyStatic;
+		layers[j] = keyLayer;
+		masks[j] = keyMask;
+	}
+}
+
+// Used after many insertions (level loading), where an insertion sort would go quadratic
+void SweepAndPrune::FullSort() {
+	order.resize(count);
+	for (int i = 0; i < count; i++) {
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [this](int a, int b) { return minX[a] < minX[b]; });
+
+	auto permute = [this](auto& values, auto& scratch) {
+		scratch.resize(count);
+		for (int i = 0; i < count; i++) {
+			scratch[i] = values[order[i]];
+		}
+		std::copy(scratch.begin(), scratch.end(), values.begin());
+	};
+	permute(minX, scratchFloats);
+	permute(maxX, scratchFloats);
+	permute(minY, scratchFloats);
+	permute(maxY, scratchFloats);
+	permute(entityIds, scratchInts);
+	permute(staticMasks, scratchInts);
+	permute(layers, scratchBits);
+	permute(masks, scratchBits);
+}
+
+void SweepAndPrune::Sort() {
+	if (!isSortDirty) {
+		return;
+	}
+
+	Compact();
+	if (insertedSinceSort > 32 && insertedSinceSort * 8 > count) {
+		FullSort();
+	} else {
+		InsertionSort();
+	}
+	WriteSentinels();
+	maxWidth = 0.0f;
+	for (int i = 0; i < count; i++) {
+		indexByEntity[entityIds[i]] = i;
+		maxWidth = std::max(maxWidth, maxX[i] - minX[i]);
+	}
+
+	insertedSinceSort = 0;
+	isSortDirty = false;
+}
+
+void SweepAndPrune::FindPairs(std::vector<CollisionPair>& pairs) {
+	Sort();
+
+	for (int i = 0; i < count; i++) {
+		const float boxMinX = minX[i], boxMaxX = maxX[i], boxMinY = minY[i], boxMaxY = maxY[i];
+		const int entityId = entityIds[i];
+		const uint32_t layer = layers[i], mask = masks[i];
+		int j = i + 1;
+
+#if defined(SWEEP_AND_PRUNE_SSE)
+		// Every box from j on starts at or after this one; it overlaps on x while it starts before this one ends
+		const __m128 vMinX = _mm_set1_ps(boxMinX), vMaxX = _mm_set1_ps(boxMaxX);
+		const __m128 vMinY = _mm_set1_ps(boxMinY), vMaxY = _mm_set1_ps(boxMaxY);
+		const __m128 vStatic = _mm_castsi128_ps(_mm_set1_epi32(staticMasks[i]));
+		const __m128i vLayer = _mm_set1_epi32(static_cast<int>(layer)), vMask = _mm_set1_epi32(static_cast<int>(mask));
+		const __m128i zero = _mm_setzero_si128();
+		for (;; j += 4) {
+			const __m128 startsBefore = _mm_cmplt_ps(_mm_loadu_ps(&minX[j]), vMaxX);
+			const __m128 overlapX = _mm_and_ps(startsBefore, _mm_cmpgt_ps(_mm_loadu_ps(&maxX[j]), vMinX));
+			const __m128 overlapY = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(&minY[j]), vMaxY), _mm_cmpgt_ps(_mm_loadu_ps(&maxY[j]), vMinY));
+			const __m128 bothStatic = _mm_and_ps(vStatic, _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&staticMasks[j]))));
+			// Lanes where either filter rejects the other: (layer[j] & mask) == 0 or (layer & mask[j]) == 0
+			const __m128i otherLayers = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&layers[j]));
+			const __m128i otherMasks = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&masks[j]));
+			const __m128 filtered = _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(_mm_and_si128(otherLayers, vMask), zero), _mm_cmpeq_epi32(_mm_and_si128(vLayer, otherMasks), zero)));
+			const __m128 rejected = _mm_or_ps(bothStatic, filtered);
+			const int hits = _mm_movemask_ps(_mm_andnot_ps(rejected, _mm_and_ps(overlapX, overlapY)));
+			for (int lane = 0; hits != 0 && lane < 4; lane++) {
+				if (hits & (1 << lane)) {
+					const int otherId = entityIds[j + lane];
+					pairs.push_back({ std::min(entityId, otherId), std::max(entityId, otherId) });
+				}
+			}
+			// Sorted order: once a lane starts past this box, so do all later boxes
+			if (_mm_movemask_ps(startsBefore) != 0xF) {
+				break;
+			}
+		}
+#else
+		for (; minX[j] < boxMaxX; j++) {
+			if ((staticMasks[i] & staticMasks[j]) != 0 || (layers[j] & mask) == 0 || (layer & masks[j]) == 0) {
+				continue;
+			}
+			if (maxX[j] > boxMinX && minY[j] < boxMaxY && maxY[j] > boxMinY) {
+				const int otherId = entityIds[j];
+				pairs.push_back({ std::min(entityId, otherId), std::max(entityId, otherId) });
+			}
+		}
+#endif
+	}
+}
+
+void SweepAndPrune::Prepare() {
+	Sort();
+}
+
+void SweepAndPrune::Query(const AABB& box, uint32_t layerMask, BroadphaseQueryCallback callback, void* context) const {
+
+	// Boxes sorted by min x: no box starting more than maxWidth before the query can reach it,
+	// and none starting past the query's end can overlap it
+	const int first = static_cast<int>(std::lower_bound(minX.begin(), minX.begin() + count, box.min.x - maxWidth) - minX.begin());
+	for (int i = first; i < count && minX[i] < box.max.x; i++) {
+		if ((layers[i] & layerMask) != 0 && maxX[i] > box.min.x && minY[i] < box.max.y && maxY[i] > box.min.y) {
+			callback(context, entityIds[i], { glm::vec2(minX[i], minY[i]), glm::vec2(maxX[i], maxY[i]) });
+		}
+	}
+}
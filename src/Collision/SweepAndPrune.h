@@ -0,0 +1,60 @@
+#ifndef SWEEPANDPRUNE_H
+#define SWEEPANDPRUNE_H
+
+#include "Broadphase.h"
+#include <vector>
+
+//*************************************************************************************
+// SWEEP AND PRUNE
+// Sort-and-sweep broadphase on the x axis. Boxes are kept sorted by their min x in packed
+// arrays (one array per bound), and the sweep tests each box against the boxes that
+// start before it ends, four at a time with SSE, collision filters included. Boxes move little between frames, so the
+// order is repaired with an insertion sort that runs in close to linear time.
+// Works best when boxes are spread out along x, as in side-scrolling levels.
+//*************************************************************************************
+
+class SweepAndPrune : public IBroadphase {
+private:
+	// Sorted by minX; the real boxes are followed by SIMD_PADDING sentinels that start at +infinity,
+	// so the sweep can always load a full vector and stops at the end without a bounds check
+	std::vector<float> minX;
+	std::vector<float> maxX;
+	std::vector<float> minY;
+	std::vector<float> maxY;
+	std::vector<int> entityIds;			// -1 for removed boxes until the next sort
+	std::vector<int> staticMasks;		// all bits set for static boxes, zero otherwise
+	std::vector<uint32_t> layers;
+	std::vector<uint32_t> masks;
+	int count = 0;
+	float maxWidth = 0.0f;				// widest box, bounds how far before a query a box can start
+
+	std::vector<int> indexByEntity;		// [index = entity id], -1 when not inserted
+	int insertedSinceSort = 0;
+	bool isSortDirty = false;
+
+	// Scratch space for full re-sorts
+	std::vector<int> order;
+	std::vector<float> scratchFloats;
+	std::vector<int> scratchInts;
+	std::vector<uint32_t> scratchBits;
+
+	void WriteSentinels();
+	void Compact();
+	void InsertionSort();
+	void FullSort();
+	void Sort();
+
+public:
+	static const int SIMD_PADDING = 4;
+
+	SweepAndPrune();
+
+	void Insert(int entityId, const AABB& box, bool isStatic, const CollisionFilter& filter) override;
+	void Remove(int entityId) override;
+	void Move(int entityId, const AABB& box) override;
+	void FindPairs(std::vector<CollisionPair>& pairs) override;
+	void Prepare() override;
+	void Query(const AABB& box, uint32_t layerMask, BroadphaseQueryCallback callback, void* context) const override;
+};
+
+#endif
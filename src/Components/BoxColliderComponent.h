@@ -0,0 +1,36 @@
+#ifndef BOXCOLLIDERCOMPONENT_H
+#define BOXCOLLIDERCOMPONENT_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+
+// Collision layer bits; a collider sits on its layer and only collides with the layers in its mask
+enum CollisionLayer : uint32_t {
+	COLLISION_LAYER_NONE = 0,
+	COLLISION_LAYER_DEFAULT = 1 << 0,
+	COLLISION_LAYER_PLAYER = 1 << 1,
+	COLLISION_LAYER_ENEMY = 1 << 2,
+	COLLISION_LAYER_PLAYER_PROJECTILE = 1 << 3,
+	COLLISION_LAYER_ENEMY_PROJECTILE = 1 << 4,
+	COLLISION_LAYER_SCENERY = 1 << 5,
+	COLLISION_LAYER_ALL = 0xFFFFFFFF
+};
+
+struct BoxColliderComponent {
+	int width;
+	int height;
+	glm::vec2 offset;
+	uint32_t layer;
+	uint32_t mask;
+
+	// Initialize component using constructor method
+	BoxColliderComponent(int width = 0, int height = 0, glm::vec2 offset = glm::vec2(0), uint32_t layer = COLLISION_LAYER_DEFAULT, uint32_t mask = COLLISION_LAYER_ALL) {
+		this->width = width;
+		this->height = height;
+		this->offset = offset;
+		this->layer = layer;
+		this->mask = mask;
+	}
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef HIERARCHYCOMPONENT_H
+#define HIERARCHYCOMPONENT_H
+
+#include <glm/glm.hpp>
+
+// Attaches an entity to a parent entity (e.g. a turret on a tank)
+// The entity's TransformComponent becomes its world transform and is computed by the HierarchySystem
+// from the parent's world transform and the local transform below
+struct HierarchyComponent {
+	int parentId;
+	glm::vec2 localPosition;
+	glm::vec2 localScale;
+	double localRotation;
+
+	// Initialize component using constructor method
+	HierarchyComponent(int parentId = -1, glm::vec2 localPosition = glm::vec2(0, 0), glm::vec2 localScale = glm::vec2(1, 1), double localRotation = 0.0) {
+		this->parentId = parentId;
+		this->localPosition = localPosition;
+		this->localScale = localScale;
+		this->localRotation = localRotation;
+	}
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef NAVIGATIONCOMPONENT_H
+#define NAVIGATIONCOMPONENT_H
+
+#include <glm/glm.hpp>
+#include <vector>
+
+struct NavigationComponent {
+	float speed;
+	glm::vec2 destination;		// world position
+	bool hasDestination;
+	bool isRepathRequired;		// set after changing the destination
+	bool isUsingFlowField;		// steer by the destination's shared flow field instead of an own path
+
+	// Path state, owned by the NavigationSystem
+	int pathRequestId;			// request whose answer is awaited, 0 if none
+	unsigned int pathMapVersion;	// tile map version the path was found on
+	std::vector<glm::vec2> waypoints;
+	size_t waypointIndex;
+
+	// Initialize component using constructor method
+	NavigationComponent(float speed = 100.0f, glm::vec2 destination = glm::vec2(0.0, 0.0), bool hasDestination = false, bool isUsingFlowField = false) {
+		this->speed = speed;
+		this->destination = destination;
+		this->hasDestination = hasDestination;
+		this->isRepathRequired = hasDestination;
+		this->isUsingFlowField = isUsingFlowField;
+		this->pathRequestId = 0;
+		this->pathMapVersion = 0;
+		this->waypointIndex = 0;
+	}
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef PARTICLEEMITTERCOMPONENT_H
+#define PARTICLEEMITTERCOMPONENT_H
+
+#include <string>
+#include <SDL.h>
+#include <glm/glm.hpp>
+
+struct ParticleEmitterComponent {
+	std::string assetId;		// texture of the particles
+	float rate;					// particles per second while emitting
+	float lifetime;				// seconds
+	float minSpeed;
+	float maxSpeed;
+	float direction;			// degrees, 0 = right, 90 = down
+	float spread;				// degrees around the direction
+	float startSize;
+	float endSize;
+	SDL_Color startColor;
+	SDL_Color endColor;
+	glm::vec2 acceleration;		// e.g. gravity for dust, an upward drift for smoke
+	glm::vec2 offset;			// from the entity's position
+	bool isEmitting;
+	float emitAccumulator;		// fraction of a particle carried over to the next step
+
+	// Initialize component using constructor method
+	ParticleEmitterComponent(std::string assetId = "", float rate = 0.0f, float lifetime = 1.0f, float minSpeed = 0.0f, float maxSpeed = 0.0f, float direction = 0.0f, float spread = 360.0f,
+		float startSize = 4.0f, float endSize = 4.0f, SDL_Color startColor = { 255, 255, 255, 255 }, SDL_Color endColor = { 255, 255, 255, 0 }, glm::vec2 acceleration = glm::vec2(0), glm::vec2 offset = glm::vec2(0)) {
+		this->assetId = assetId;
+		this->rate = rate;
+		this->lifetime = lifetime;
+		this->minSpeed = minSpeed;
+		this->maxSpeed = maxSpeed;
+		this->direction = direction;
+		this->spread = spread;
+		this->startSize = startSize;
+		this->endSize = endSize;
+		this->startColor = startColor;
+		this->endColor = endColor;
+		this->acceleration = acceleration;
+		this->offset = offset;
+		this->isEmitting = true;
+		this->emitAccumulator = 0.0f;
+	}
+};
+
+#endif
@@ -6,8 +6,18 @@
 struct RigidBodyComponent {
 	glm::vec2 velocity;
 
-	RigidBodyComponent(glm::vec2 velocity = glm::vec2(0.0,0.0)) {
+	// Fast movers are collided along their whole path each step, so they cannot tunnel through thin objects
+	bool isFastMoving;
+
+	// Sleep state, owned by the SleepSystem: steps in a row spent below the sleep speed, and whether the body sleeps
+	int slowFrames;
+	bool isSleeping;
+
+	RigidBodyComponent(glm::vec2 velocity = glm::vec2(0.0,0.0), bool isFastMoving = false) {
 		this->velocity = velocity;
+		this->isFastMoving = isFastMoving;
+		this->slowFrames = 0;
+		this->isSleeping = false;
 	}
 };
 
@@ -0,0 +1,23 @@
+#ifndef STEERINGCOMPONENT_H
+#define STEERINGCOMPONENT_H
+
+#include <glm/glm.hpp>
+
+struct SteeringComponent {
+	float maxSpeed;
+	float separationWeight;		// keep away from neighbours
+	float alignmentWeight;		// match the neighbours' velocity
+	float avoidanceWeight;		// turn away from solid tiles ahead
+	glm::vec2 desiredVelocity;	// where the unit wants to go this step, e.g. set by the NavigationSystem
+
+	// Initialize component using constructor method
+	SteeringComponent(float maxSpeed = 100.0f, float separationWeight = 1.0f, float alignmentWeight = 0.1f, float avoidanceWeight = 1.0f) {
+		this->maxSpeed = maxSpeed;
+		this->separationWeight = separationWeight;
+		this->alignmentWeight = alignmentWeight;
+		this->avoidanceWeight = avoidanceWeight;
+		this->desiredVelocity = glm::vec2(0.0, 0.0);
+	}
+};
+
+#endif
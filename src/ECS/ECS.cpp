@@ -2,31 +2,68 @@
 #include "../Logger.h"
 #include <algorithm>
 
-int IComponent::nextId = 0;
+std::atomic<int> IComponent::nextId = 0;
 
 int Entity::GetId() const {
 	return id;
 }
 
+System::System() {
+	entities.emplace(std::pmr::get_default_resource());
+}
+
+void System::SetMemoryResource(std::pmr::memory_resource* memoryResource) {
+	entities.emplace(memoryResource);
+}
+
 void System::AddEntityToSystem(Entity entity) {
-	entities.push_back(entity);
+	entities->push_back(entity);
+	version++;
 }
 
 // iterate values using a Lamda function
 void System::RemoveEntityFromSystem(Entity entity) {
-	entities.erase(std::remove_if(entities.begin(), entities.end(), [&entity](Entity other) {
+	entities->erase(std::remove_if(entities->begin(), entities->end(), [&entity](Entity other) {
 		return entity == other; //(using operator overloading)
-		}), entities.end());
+		}), entities->end());
+	version++;
+}
+
+void System::ClearEntities() {
+	entities->clear();
+	version++;
+	clearCount++;
 }
 
-std::vector<Entity> System::GetSystemEntities() const {
-	return entities;
+// Return by reference so iterating a system's entities each frame does not copy the list
+const std::pmr::vector<Entity>& System::GetSystemEntities() const {
+	return *entities;
 }
 
 const Signature& System::GetComponentSignature() const {
 	return componentSignature;
 }
 
+unsigned int System::GetVersion() const {
+	return version;
+}
+
+unsigned int System::GetClearCount() const {
+	return clearCount;
+}
+
+std::pmr::memory_resource* Registry::GetMemoryResource() const {
+	return memoryResource;
+}
+
+int Registry::GetNumEntities() const {
+	return numEntities;
+}
+
+const Signature& Registry::GetComponentSignature(Entity entity) const {
+	return entityComponentSignatures[entity.GetId()];
+}
+
 Entity Registry::CreateEntity() {
 	int entityId;
 
@@ -35,7 +72,7 @@ Entity Registry::CreateEntity() {
 	// Flag new entity to be created before the next frame
 	Entity entity(entityId);
 	entity.registry = this;
-	entitiesToBeAdded.insert(entity);
+	entitiesToBeAdded.push_back(entity);
 
 
 	// make sure the entityComponentsignatures vector can accomodate the new entity
@@ -77,4 +114,21 @@ void Registry::Update() {
 	// Remove the entities that are waiting to be killed from the active systems
 
 
-}
\ No newline at end of file
+}
+
+// Runs in O(number of systems): the signatures, pending lists and system entity lists hold
+// trivially destructible values so clearing them does not touch each entity. Component pools
+// are left as they are; with every signature off their old contents are unreachable and get
+// overwritten as the next level adds components, so the pools stay sized for reuse
+void Registry::Clear() {
+	numEntities = 0;
+	entityComponentSignatures.clear();
+	entitiesToBeAdded.clear();
+	entitiesToBeKilled.clear();
+
+	for (auto& system : systems) {
+		system.second->ClearEntities();
+	}
+
+	Logger::Log("Registry cleared");
+}
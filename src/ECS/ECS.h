@@ -4,10 +4,12 @@
 #include "../Logger.h"
 #include <vector>
 #include <bitset>
-#include <set>
 #include <unordered_map>
 #include <typeindex>
 #include <memory>
+#include <memory_resource>
+#include <optional>
+#include <atomic>
 
 const unsigned int MAX_COMPONENTS = 32;
 //*************************************************************************************
@@ -18,9 +20,11 @@ const unsigned int MAX_COMPONENTS = 32;
 
 typedef std::bitset<MAX_COMPONENTS> Signature;
 
+// nextId is atomic because registries may be built on a worker thread (level preloading)
+// while the main thread registers component types of its own
 struct IComponent {
 protected:
-	static int nextId;
+	static std::atomic<int> nextId;
 };
 
 // used to assign a unique id to a component type
@@ -69,17 +73,32 @@ public:
 class System {
 private:
 	Signature componentSignature;
-	std::vector<Entity> entities;
+
+	// pmr containers keep the resource they were built with, so the list is rebuilt
+	// in place when the owning registry hands the system its memory resource
+	std::optional<std::pmr::vector<Entity>> entities;
+
+	// Bumped whenever the entity list changes, so systems that keep derived data can tell when to rebuild it
+	unsigned int version = 0;
+
+	// Bumped when the entity list is cleared by Registry::Clear, after which entity ids start again from 0
+	unsigned int clearCount = 0;
 
 public:
-	System() = default;
+	System();
 	//virtual ~System() = default;
 	~System() = default;
 
 	void AddEntityToSystem(Entity entity);
 	void RemoveEntityFromSystem(Entity entity);
-	std::vector<Entity> GetSystemEntities() const;
+	void ClearEntities();
+	const std::pmr::vector<Entity>& GetSystemEntities() const;
 	const Signature& GetComponentSignature() const;
+	unsigned int GetVersion() const;
+	unsigned int GetClearCount() const;
+
+	// Allocate the system's entity list from the given memory resource (called by the registry before any entity is added)
+	void SetMemoryResource(std::pmr::memory_resource* memoryResource);
 
 	// Define the component type T that entities must have to be considered by the system
 	template <typename TComponent> void RequireComponent();
@@ -88,6 +107,7 @@ public:
 //*************************************************************************************
 // POOL CLASS
 // A pool is a vector (contiguous data) of objects of type T
+// The vector draws its memory from the registry's memory resource
 //*************************************************************************************
 
 class IPool {						// base/parent class IPool
@@ -98,10 +118,10 @@ public:
 template <typename T>
 class Pool : public IPool {
 private:
-	std::vector<T> data;
+	std::pmr::vector<T> data;
 
 public:
-	Pool(int size = 100) {
+	Pool(int size = 100, std::pmr::memory_resource* memoryResource = std::pmr::get_default_resource()): data(memoryResource) {
 		data.resize(size);
 	}
 
@@ -145,10 +165,15 @@ public:
 // REGISTRY
 // The registry manages the creation and destruction of entities, as well as
 // adding systems and adding components to entities
+// All internal storage is allocated from a single memory resource, so a whole level
+// can be carved out of one arena and released in one shot
 //*************************************************************************************
 
 class Registry {
 private:
+	// Memory resource backing every pool, system and container owned by the registry
+	std::pmr::memory_resource* memoryResource;
+
 	// Keeping track of how many entities were added to the scene
 	int numEntities = 0;
 
@@ -156,23 +181,30 @@ private:
 	// Each pool contains all the data for a certain component type
 	// [vector index = component type id]
 	// [pool index = entity id]
-	std::vector<std::shared_ptr<IPool>> componentPools;			// default back to parent class for type
+	std::pmr::vector<std::shared_ptr<IPool>> componentPools;			// default back to parent class for type
 
 	// Vector of component signatures per entity, indicating which component is turned 'on' for a given entity
 	// [Vector index = entity id]
-	std::vector<Signature> entityComponentSignatures;
+	std::pmr::vector<Signature> entityComponentSignatures;
 
 	// Map of active systems [index = system typeId]
 	// Unordered_map can be used since we do not need to keep the elements sorted
-	std::unordered_map<std::type_index, std::shared_ptr<System>> systems;
+	std::pmr::unordered_map<std::type_index, std::shared_ptr<System>> systems;
 
 	// Avoid creating or destroying entities in the middle of the game logic by flagging entities 
 	// to be added or removed in the next registry Update()
-	std::set<Entity> entitiesToBeAdded;		// Entities awaiting creation in the next Registry Update()
-	std::set<Entity> entitiesToBeKilled;	// Entities awaiting destruction in the next Registry Update()
+	// (ids are handed out in increasing order, so plain vectors stay sorted and clear in constant time)
+	std::pmr::vector<Entity> entitiesToBeAdded;		// Entities awaiting creation in the next Registry Update()
+	std::pmr::vector<Entity> entitiesToBeKilled;	// Entities awaiting destruction in the next Registry Update()
 
 public:
-	Registry() {
+	Registry(std::pmr::memory_resource* memoryResource = std::pmr::get_default_resource()):
+		memoryResource(memoryResource),
+		componentPools(memoryResource),
+		entityComponentSignatures(memoryResource),
+		systems(memoryResource),
+		entitiesToBeAdded(memoryResource),
+		entitiesToBeKilled(memoryResource) {
 		Logger::Log("Registry constructor called");
 	}
 
@@ -183,6 +215,12 @@ public:
 	// Process entities that are waiting to be added/killed
 	void Update();
 
+	// Release every entity and component while keeping the systems and the pool capacity for reuse
+	void Clear();
+
+	std::pmr::memory_resource* GetMemoryResource() const;
+	int GetNumEntities() const;
+
 	// Entity Management
 	Entity CreateEntity();
 
@@ -191,6 +229,12 @@ public:
 	template <typename TComponent> void RemoveComponent(Entity entity);
 	template <typename TComponent> bool HasComponent(Entity entity) const;
 	template <typename TComponent> TComponent& GetComponent(Entity entity) const;
+
+	// Which components the entity has [bit = component type id], to test several without a lookup each
+	const Signature& GetComponentSignature(Entity entity) const;
+
+	// Direct access to a component pool [pool index = entity id], for systems that stream over many entities
+	template <typename TComponent> Pool<TComponent>& GetComponentPool() const;
 	
 	// System management
 	template <typename TSystem, typename ...TArgs> void AddSystem(TArgs&& ...args);
@@ -215,7 +259,8 @@ void System::RequireComponent() {
 
 template <typename TSystem, typename ...TArgs>
 void Registry::AddSystem(TArgs&& ...args) {
-	std::shared_ptr<TSystem> newSystem = std::make_shared<TSystem>(std::forward<TArgs>(args)...);
+	std::shared_ptr<TSystem> newSystem = std::allocate_shared<TSystem>(std::pmr::polymorphic_allocator<TSystem>(memoryResource), std::forward<TArgs>(args)...);
+	newSystem->SetMemoryResource(memoryResource);
 	systems.insert(std::make_pair(std::type_index(typeid(TSystem)), newSystem));
 }
 
@@ -248,7 +293,7 @@ void Registry::AddComponent(Entity entity, TArgs&& ...args) {
 
 	// if no position in component pool, create new pool
 	if (!componentPools[componentId]) {
-		std::shared_ptr <Pool<TComponent>> newComponentPool = std::make_shared <Pool<TComponent>>();
+		std::shared_ptr <Pool<TComponent>> newComponentPool = std::allocate_shared <Pool<TComponent>>(std::pmr::polymorphic_allocator<Pool<TComponent>>(memoryResource), 100, memoryResource);
 		componentPools[componentId] = newComponentPool;
 	}
 
@@ -290,10 +335,15 @@ bool Registry::HasComponent(Entity entity) const {
 
 template <typename TComponent>
 TComponent& Registry::GetComponent(Entity entity) const {
-	const auto componentId = Component<TComponent>::GetId();
 	const auto entityId = entity.GetId();
-	auto componentPool = std::static_pointer_cast<Pool<TComponent>> (componentPools[componentId]);
-	return componentPool->Get(entityId);
+	return GetComponentPool<TComponent>().Get(entityId);
+}
+
+template <typename TComponent>
+Pool<TComponent>& Registry::GetComponentPool() const {
+	// Cast the raw pointer rather than copying the shared_ptr, which would touch its atomic ref count on every access
+	const auto componentId = Component<TComponent>::GetId();
+	return *static_cast<Pool<TComponent>*>(componentPools[componentId].get());
 }
 
 
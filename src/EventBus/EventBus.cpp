@@ -0,0 +1,73 @@
+#include "EventBus.h"
+#include "../Logger.h"
+
+int IEventType::nextId = 0;
+
+// Upper bound on how many times handlers may chain new events within one frame
+const int MAX_DISPATCH_ROUNDS = 8;
+
+EventBus::EventBus(size_t frameMemorySize) {
+	frameBuffer.resize(frameMemorySize);
+	frameMemory.emplace(frameBuffer.data(), frameBuffer.size());
+	Logger::Log("EventBus constructor called");
+}
+
+EventBus::~EventBus() {
+	// The queues hold memory from the frame arena, so they go first
+	eventQueues.clear();
+	Logger::Log("EventBus destructor called");
+}
+
+void EventBus::DispatchEvents() {
+	for (int round = 0; round < MAX_DISPATCH_ROUNDS; round++) {
+		bool hasDispatched = false;
+		for (auto& eventQueue : eventQueues) {
+			if (eventQueue && eventQueue->HasEvents()) {
+				eventQueue->Dispatch();
+				hasDispatched = true;
+			}
+		}
+		if (!hasDispatched) {
+			return;
+		}
+	}
+
+	for (auto& eventQueue : eventQueues) {
+		if (eventQueue && eventQueue->HasEvents()) {
+			Logger::Err("Events still pending after " + std::to_string(MAX_DISPATCH_ROUNDS) + " dispatch rounds were dropped");
+			return;
+		}
+	}
+}
+
+void EventBus::Reset() {
+	size_t requiredBytes = 0;
+	for (auto& eventQueue : eventQueues) {
+		if (eventQueue) {
+			eventQueue->ReleaseFrameMemory();
+			requiredBytes += eventQueue->GetRequiredBytes();
+		}
+	}
+
+	// Grow the arena if the busiest frame so far did not fit (this only happens while warming up)
+	frameMemory.reset();
+	if (requiredBytes > frameBuffer.size()) {
+		frameBuffer.resize(requiredBytes * 2);
+		Logger::Log("EventBus frame memory grown to " + std::to_string(frameBuffer.size()) + " bytes");
+	}
+	frameMemory.emplace(frameBuffer.data(), frameBuffer.size());
+
+	for (auto& eventQueue : eventQueues) {
+		if (eventQueue) {
+			eventQueue->AcquireFrameMemory(&*frameMemory);
+		}
+	}
+}
+
+void EventBus::ClearSubscribers() {
+	for (auto& eventQueue : eventQueues) {
+		if (eventQueue) {
+			eventQueue->ClearHandlers();
+		}
+	}
+}
@@ -0,0 +1,190 @@
+#ifndef EVENTBUS_H
+#define EVENTBUS_H
+
+#include "../Logger.h"
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <functional>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+
+//*************************************************************************************
+// EVENT TYPE
+// Used to assign a unique id to an event type, the same way components get theirs
+//*************************************************************************************
+
+struct IEventType {
+protected:
+	static int nextId;
+};
+
+template <typename TEvent>
+class EventType : public IEventType {
+public:
+	static int GetId() {
+		static auto id = nextId++;
+		return id;
+	}
+};
+
+//*************************************************************************************
+// EVENT QUEUE
+// A contiguous queue of events of one type, allocated from the bus's per-frame arena.
+// Two buffers are kept so handlers can emit events of the same type while a batch is
+// being dispatched: new events go to the back buffer and are delivered in the next round.
+//*************************************************************************************
+
+class IEventQueue {
+public:
+	virtual ~IEventQueue() {}
+	virtual bool HasEvents() const = 0;
+	virtual void Dispatch() = 0;
+	virtual size_t GetRequiredBytes() const = 0;
+	virtual void ReleaseFrameMemory() = 0;
+	virtual void AcquireFrameMemory(std::pmr::memory_resource* frameMemory) = 0;
+	virtual void ClearHandlers() = 0;
+};
+
+template <typename TEvent>
+class EventQueue : public IEventQueue {
+public:
+	using Events = std::pmr::vector<TEvent>;
+	using Handler = std::function<void(const Events&)>;
+
+private:
+	// pmr containers keep the resource they were built with, so they are rebuilt each frame
+	std::optional<Events> pending;		// events emitted since the last dispatch round
+	std::optional<Events> dispatching;	// batch currently handed to the handlers
+	std::vector<Handler> handlers;
+
+	size_t eventsThisFrame = 0;			// used to size next frame's buffers up front
+	size_t expectedEvents = 0;
+
+public:
+	EventQueue() {
+		AcquireFrameMemory(std::pmr::get_default_resource());
+	}
+
+	virtual ~EventQueue() = default;
+
+	template <typename ...TArgs>
+	void Emit(TArgs&& ...args) {
+		pending->emplace_back(std::forward<TArgs>(args)...);
+		eventsThisFrame++;
+	}
+
+	void AddHandler(Handler handler) {
+		handlers.push_back(std::move(handler));
+	}
+
+	bool HasEvents() const override {
+		return !pending->empty();
+	}
+
+	// One call per handler with the whole batch, instead of one call per event per handler
+	void Dispatch() override {
+		std::swap(pending, dispatching);
+		for (auto& handler : handlers) {
+			handler(*dispatching);
+		}
+		dispatching->clear();
+	}
+
+	size_t GetRequiredBytes() const override {
+		// Both buffers are reserved to last frame's count, plus room for alignment
+		return 2 * (std::max(eventsThisFrame, expectedEvents) * sizeof(TEvent) + alignof(TEvent));
+	}
+
+	void ReleaseFrameMemory() override {
+		expectedEvents = std::max(eventsThisFrame, expectedEvents);
+		eventsThisFrame = 0;
+		pending.reset();
+		dispatching.reset();
+	}
+
+	void AcquireFrameMemory(std::pmr::memory_resource* frameMemory) override {
+		pending.emplace(frameMemory);
+		dispatching.emplace(frameMemory);
+		pending->reserve(expectedEvents);
+		dispatching->reserve(expectedEvents);
+	}
+
+	void ClearHandlers() override {
+		handlers.clear();
+	}
+};
+
+//*************************************************************************************
+// EVENT BUS
+// Events are queued per type and delivered in batches when DispatchEvents() is called.
+// All queues draw from one arena that is reset every frame and sized from the busiest
+// frame seen so far, so once warmed up the bus does not touch the heap.
+//*************************************************************************************
+
+class EventBus {
+private:
+	// Vector of event queues [vector index = event type id]
+	std::vector<std::unique_ptr<IEventQueue>> eventQueues;
+
+	std::vector<std::byte> frameBuffer;
+	std::optional<std::pmr::monotonic_buffer_resource> frameMemory;
+
+	template <typename TEvent> EventQueue<TEvent>& GetEventQueue();
+
+public:
+	EventBus(size_t frameMemorySize = 64 * 1024);
+	~EventBus();
+
+	// Subscribe a handler that receives every event of type TEvent emitted this frame as one batch
+	template <typename TEvent> void SubscribeToEvent(typename EventQueue<TEvent>::Handler handler);
+	template <typename TEvent, typename TOwner> void SubscribeToEvent(TOwner* owner, void (TOwner::*callback)(const std::pmr::vector<TEvent>&));
+	template <typename TEvent, typename ...TArgs> void EmitEvent(TArgs&& ...args);
+
+	// Deliver all queued events; events emitted by handlers are delivered in further rounds
+	void DispatchEvents();
+
+	// Drop this frame's events and rewind the frame arena (call once per frame after dispatching)
+	void Reset();
+
+	// Remove every subscriber, e.g. when the systems that subscribed are replaced by a new level
+	void ClearSubscribers();
+};
+
+template <typename TEvent>
+EventQueue<TEvent>& EventBus::GetEventQueue() {
+	const auto eventId = EventType<TEvent>::GetId();
+
+	if (eventId >= static_cast<int>(eventQueues.size())) {
+		eventQueues.resize(eventId + 1);
+	}
+
+	if (!eventQueues[eventId]) {
+		auto newEventQueue = std::make_unique<EventQueue<TEvent>>();
+		newEventQueue->AcquireFrameMemory(&*frameMemory);
+		eventQueues[eventId] = std::move(newEventQueue);
+	}
+
+	return static_cast<EventQueue<TEvent>&>(*eventQueues[eventId]);
+}
+
+template <typename TEvent>
+void EventBus::SubscribeToEvent(typename EventQueue<TEvent>::Handler handler) {
+	GetEventQueue<TEvent>().AddHandler(std::move(handler));
+}
+
+template <typename TEvent, typename TOwner>
+void EventBus::SubscribeToEvent(TOwner* owner, void (TOwner::*callback)(const std::pmr::vector<TEvent>&)) {
+	GetEventQueue<TEvent>().AddHandler([owner, callback](const std::pmr::vector<TEvent>& events) {
+		(owner->*callback)(events);
+	});
+}
+
+template <typename TEvent, typename ...TArgs>
+void EventBus::EmitEvent(TArgs&& ...args) {
+	GetEventQueue<TEvent>().Emit(std::forward<TArgs>(args)...);
+}
+
+#endif
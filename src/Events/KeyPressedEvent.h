@@ -0,0 +1,14 @@
+#ifndef KEYPRESSEDEVENT_H
+#define KEYPRESSEDEVENT_H
+
+#include <SDL.h>
+
+struct KeyPressedEvent {
+	SDL_Keycode symbol;
+
+	KeyPressedEvent(SDL_Keycode symbol = 0) {
+		this->symbol = symbol;
+	}
+};
+
+#endif
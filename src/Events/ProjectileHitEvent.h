@@ -0,0 +1,16 @@
+#ifndef PROJECTILEHITEVENT_H
+#define PROJECTILEHITEVENT_H
+
+#include "../ECS/ECS.h"
+#include <glm/glm.hpp>
+
+// A projectile hit an entity's collider; the projectile is gone by the time the event is delivered
+struct ProjectileHitEvent {
+	Entity target;
+	int ownerId;			// entity that fired the projectile, -1 for none
+	glm::vec2 position;		// where the projectile was when it hit
+
+	ProjectileHitEvent(Entity target, int ownerId, glm::vec2 position): target(target), ownerId(ownerId), position(position) {}
+};
+
+#endif
@@ -0,0 +1,153 @@
+#include "FramePacer.h"
+#include "../Logger.h"
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+// Adaptive mode: frames in a row needed before the rate is lowered or raised again
+const int ADAPTIVE_OVERRUN_FRAMES = 10;
+const int ADAPTIVE_HEADROOM_FRAMES = 120;
+const int ADAPTIVE_MAX_RATE_DIVISOR = 4;
+
+// A frame ending later than this past its deadline counts as late
+const double LATE_FRAME_TOLERANCE = 0.0005;
+
+// Weight of the newest frame in the running averages
+const double STATS_SMOOTHING = 0.05;
+
+FramePacer::FramePacer(double targetFrameRate, FramePacingMode mode) {
+	this->mode = mode;
+	this->targetFrameTime = 1.0 / targetFrameRate;
+	this->frequency = SDL_GetPerformanceFrequency();
+}
+
+void FramePacer::SetMode(FramePacingMode mode) {
+	this->mode = mode;
+	rateDivisor = 1;
+	overrunStreak = 0;
+	headroomStreak = 0;
+}
+
+void FramePacer::SetTargetFrameRate(double targetFrameRate) {
+	targetFrameTime = 1.0 / targetFrameRate;
+}
+
+FramePacingMode FramePacer::GetMode() const {
+	return mode;
+}
+
+const FramePacingStats& FramePacer::GetStats() const {
+	return stats;
+}
+
+double FramePacer::Seconds(Uint64 counterDelta) const {
+	return static_cast<double>(counterDelta) / frequency;
+}
+
+void FramePacer::SleepUntil(Uint64 deadline) {
+	// Sleep in whole milliseconds while the deadline is safely beyond the expected oversleep
+	Uint64 now = SDL_GetPerformanceCounter();
+	while (now < deadline) {
+		const double remaining = Seconds(deadline - now);
+		const int sleepMilliseconds = static_cast<int>((remaining - sleepOvershoot) * 1000.0);
+		if (sleepMilliseconds < 1) {
+			break;
+		}
+		SDL_Delay(sleepMilliseconds);
+		const Uint64 woken = SDL_GetPerformanceCounter();
+
+		// Track the worst recent overshoot: rise at once, decay slowly
+		const double overshoot = Seconds(woken - now) - sleepMilliseconds / 1000.0;
+		sleepOvershoot = std::max(overshoot, sleepOvershoot * 0.99);
+		now = woken;
+	}
+
+	// Spin for the last stretch, yielding so other threads can still run
+	while (SDL_GetPerformanceCounter() < deadline) {
+		std::this_thread::yield();
+	}
+}
+
+void FramePacer::UpdateAdaptiveRate(double workTime) {
+	const double frameTime = targetFrameTime * rateDivisor;
+
+	if (workTime > frameTime) {
+		headroomStreak = 0;
+		if (++overrunStreak >= ADAPTIVE_OVERRUN_FRAMES && rateDivisor < ADAPTIVE_MAX_RATE_DIVISOR) {
+			rateDivisor++;
+			overrunStreak = 0;
+			Logger::Log("Frame pacing lowered to " + std::to_string(1.0 / (targetFrameTime * rateDivisor)) + " fps");
+		}
+		return;
+	}
+
+	overrunStreak = 0;
+	// Only go back up once the work comfortably fits the faster rate
+	if (rateDivisor > 1 && workTime < 0.8 * targetFrameTime * (rateDivisor - 1)) {
+		if (++headroomStreak >= ADAPTIVE_HEADROOM_FRAMES) {
+			rateDivisor--;
+			headroomStreak = 0;
+			Logger::Log("Frame pacing raised to " + std::to_string(1.0 / (targetFrameTime * rateDivisor)) + " fps");
+		}
+	} else {
+		headroomStreak = 0;
+	}
+}
+
+void FramePacer::RecordFrame(double frameTime, double miss) {
+	stats.lastFrameTime = frameTime;
+	stats.lastMiss = miss;
+	stats.maxMiss = std::max(stats.maxMiss, miss);
+	if (stats.frameCount == 0) {
+		stats.averageMiss = std::abs(miss);
+		averageFrameTime = frameTime;
+		frameTimeVariance = 0.0;
+	} else {
+		stats.averageMiss += (std::abs(miss) - stats.averageMiss) * STATS_SMOOTHING;
+
+		// Exponentially weighted mean and variance of the frame time
+		const double deviation = frameTime - averageFrameTime;
+		averageFrameTime += deviation * STATS_SMOOTHING;
+		frameTimeVariance = (1.0 - STATS_SMOOTHING) * (frameTimeVariance + STATS_SMOOTHING * deviation * deviation);
+	}
+	stats.jitter = std::sqrt(frameTimeVariance);
+	if (miss > LATE_FRAME_TOLERANCE) {
+		stats.lateFrames++;
+	}
+	stats.frameCount++;
+}
+
+double FramePacer::WaitForNextFrame() {
+	Uint64 now = SDL_GetPerformanceCounter();
+
+	// The very first frame has nothing to wait for
+	if (frameStartCounter == 0) {
+		frameStartCounter = now;
+		deadlineCounter = now + static_cast<Uint64>(targetFrameTime * frequency);
+		return 0.0;
+	}
+
+	if (mode == PACING_ADAPTIVE) {
+		UpdateAdaptiveRate(Seconds(now - frameStartCounter));
+	}
+
+	if (mode != PACING_UNCAPPED) {
+		SleepUntil(deadlineCounter);
+		now = SDL_GetPerformanceCounter();
+	}
+
+	const double frameTime = Seconds(now - frameStartCounter);
+	const double miss = (now >= deadlineCounter) ? Seconds(now - deadlineCounter) : -Seconds(deadlineCounter - now);
+	RecordFrame(frameTime, mode == PACING_UNCAPPED ? 0.0 : miss);
+
+	// Schedule the next deadline from the previous one so small misses do not accumulate into drift,
+	// but start over from now after a frame that overran by more than a whole period
+	const Uint64 period = static_cast<Uint64>(targetFrameTime * rateDivisor * frequency);
+	deadlineCounter += period;
+	if (deadlineCounter < now) {
+		deadlineCounter = now + period;
+	}
+	frameStartCounter = now;
+
+	return frameTime;
+}
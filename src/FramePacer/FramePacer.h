@@ -0,0 +1,69 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <SDL.h>
+
+enum FramePacingMode {
+	PACING_CAPPED,		// wait until the target frame time has passed
+	PACING_UNCAPPED,	// never wait
+	PACING_ADAPTIVE		// like capped, but drops to an even fraction of the target rate while frames keep overrunning
+};
+
+// All times are in seconds
+struct FramePacingStats {
+	double lastFrameTime = 0.0;
+	double lastMiss = 0.0;			// how late the last frame ended relative to its deadline (negative = early)
+	double maxMiss = 0.0;
+	double averageMiss = 0.0;		// running average of the absolute miss
+	double jitter = 0.0;			// running standard deviation of the frame time
+	unsigned long long frameCount = 0;
+	unsigned long long lateFrames = 0;		// frames that missed their deadline by more than half a millisecond
+};
+
+//*************************************************************************************
+// FRAME PACER
+// Paces frames with the high resolution performance counter. Waiting is hybrid: the
+// thread sleeps while the deadline is further away than the measured sleep overshoot,
+// then spins (yielding) for the rest, so frames end close to their deadline even when
+// the scheduler wakes the thread late.
+//*************************************************************************************
+
+class FramePacer {
+private:
+	FramePacingMode mode;
+	double targetFrameTime;
+	int rateDivisor = 1;			// adaptive mode: current frame time is targetFrameTime * rateDivisor
+	int overrunStreak = 0;
+	int headroomStreak = 0;
+
+	Uint64 frequency;
+	Uint64 frameStartCounter = 0;
+	Uint64 deadlineCounter = 0;
+
+	// How late SDL_Delay tends to wake up; the last stretch before a deadline is spun instead of slept
+	double sleepOvershoot = 0.002;
+
+	FramePacingStats stats;
+	double averageFrameTime = 0.0;
+	double frameTimeVariance = 0.0;
+
+	double Seconds(Uint64 counterDelta) const;
+	void SleepUntil(Uint64 deadline);
+	void UpdateAdaptiveRate(double workTime);
+	void RecordFrame(double frameTime, double miss);
+
+public:
+	FramePacer(double targetFrameRate, FramePacingMode mode = PACING_CAPPED);
+
+	void SetMode(FramePacingMode mode);
+	void SetTargetFrameRate(double targetFrameRate);
+	FramePacingMode GetMode() const;
+
+	// Wait until the current frame's deadline (depending on the mode) and start the next frame
+	// Returns the real time between the start of the previous frame and the start of this one
+	double WaitForNextFrame();
+
+	const FramePacingStats& GetStats() const;
+};
+
+#endif
@@ -4,18 +4,42 @@
 #include "Components/TransformComponent.h"
 #include "Components/RigidBodyComponent.h"
 #include "Components/SpriteComponent.h"
+#include "Components/BoxColliderComponent.h"
+#include "Components/ParticleEmitterComponent.h"
+#include "Components/NavigationComponent.h"
+#include "Components/SteeringComponent.h"
+#include "./Systems/NavigationSystem.h"
+#include "./Systems/SteeringSystem.h"
 #include "./Systems/MovementSystem.h"
 #include "./Systems/RenderSystem.h"
+#include "./Systems/HierarchySystem.h"
+#include "./Systems/CollisionSystem.h"
+#include "./Systems/TileCollisionSystem.h"
+#include "./Systems/SleepSystem.h"
+#include "./Systems/ParticleSystem.h"
+#include "./Systems/StateChecksumSystem.h"
+#include "./Events/KeyPressedEvent.h"
 #include <SDL.h>
 #include <SDL_image.h>
 #include <glm/glm.hpp>
 #include <iostream>
-#include <fstream>
+#include <chrono>
+#include <cmath>
 
 Game::Game() {
     isRunning = false;
-    registry = std::make_unique<Registry>();
+    window = nullptr;
+    renderer = nullptr;
+    levelMemory = std::make_unique<std::pmr::monotonic_buffer_resource>(LEVEL_MEMORY_SIZE);
+    registry = std::make_unique<Registry>(levelMemory.get());
     assetStore = std::make_unique<AssetStore>();
+    eventBus = std::make_unique<EventBus>();
+    tileMap = std::make_unique<TileMap>();
+    jobSystem = std::make_unique<JobSystem>();
+    projectileSystem = std::make_unique<ProjectileSystem>(MAX_PROJECTILES);
+    pathRequestQueue = std::make_unique<PathRequestQueue>();
+    flowFieldCache = std::make_unique<FlowFieldCache>();
+    framePacer = std::make_unique<FramePacer>(FPS, PACING_CAPPED);
     Logger::Log("Game constructor called!");
 }
 
@@ -24,6 +48,16 @@ Game::~Game() {
 }
 
 void Game::Initialize() {
+    // A replay runs headlessly: no window, no renderer, nothing to draw
+    if (!inputReplayPath.empty()) {
+        if (SDL_Init(SDL_INIT_TIMER) != 0) {
+            Logger::Err("Error initializing SDL.");
+            return;
+        }
+        isRunning = true;
+        return;
+    }
+
     if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
         Logger::Err("Error initializing SDL.");
         return;
@@ -54,6 +88,20 @@ void Game::Initialize() {
 }
 
 void Game::ProcessInput() {
+    // A replay takes its input from the recording; it ends with the recording
+    if (inputPlayer) {
+        if (!inputPlayer->ReadFrame(frameInput)) {
+            isRunning = false;
+            return;
+        }
+        for (SDL_Keycode key : frameInput.keysPressed) {
+            eventBus->EmitEvent<KeyPressedEvent>(key);
+        }
+        return;
+    }
+
+    frameInput.keysPressed.clear();
+    frameInput.isLevelSwitched = false;
     SDL_Event sdlEvent;
     while (SDL_PollEvent(&sdlEvent)) {
         switch (sdlEvent.type) {
@@ -64,20 +112,97 @@ void Game::ProcessInput() {
             if (sdlEvent.key.keysym.sym == SDLK_ESCAPE) {
                 isRunning = false;
             }
+            eventBus->EmitEvent<KeyPressedEvent>(sdlEvent.key.keysym.sym);
+            frameInput.keysPressed.push_back(sdlEvent.key.keysym.sym);
             break;
         }
     }
 }
 
+void Game::UnloadLevel() {
+    // Drop every entity and component but keep the systems and the pools that live
+    // in the level arena, so the next level reuses their memory
+    registry->Clear();
+    tileMap->Clear();
+    projectileSystem->Clear();
+    registry->GetSystem<ParticleSystem>().Clear();
+    pathRequestQueue->Clear();
+    flowFieldCache->Clear();
+}
+
 void Game::LoadLevel(int level) {
+    // Start the level from an empty registry
+    UnloadLevel();
+
+    playerId = BuildLevel(level, *registry, *assetStore, *tileMap);
+    assetStore->CommitStagedTextures(renderer);
+
+    currentLevel = level;
+    PreloadLevel(currentLevel % NUM_LEVELS + 1);
+}
+
+void Game::AddSystems(Registry& registry) {
     // Add the systems that need to be processed in the game
-    registry->AddSystem<MovementSystem>();
-    registry->AddSystem<RenderSystem>();
+    registry.AddSystem<NavigationSystem>();
+    registry.AddSystem<SteeringSystem>();
+    registry.AddSystem<MovementSystem>();
+    registry.AddSystem<TileCollisionSystem>();
+    registry.AddSystem<HierarchySystem>();
+    registry.AddSystem<CollisionSystem>();
+    registry.AddSystem<SleepSystem>();
+    registry.AddSystem<ParticleSystem>(MAX_PARTICLES);
+    registry.AddSystem<RenderSystem>();
+    registry.AddSystem<StateChecksumSystem>();
+}
+
+void Game::SetFixedPointSimulation(bool isFixedPoint) {
+    isFixedPointSimulation = isFixedPoint;
+    if (registry->HasSystem<MovementSystem>()) {
+        ConfigureSystems();
+    }
+}
+
+void Game::RecordInput(const std::string& filePath) {
+    inputRecordingPath = filePath;
+}
+
+void Game::ReplayInput(const std::string& filePath, const std::string& profilePath) {
+    inputReplayPath = filePath;
+    frameProfilePath = profilePath;
+}
+
+// Applies the game's simulation settings to the systems of the current registry
+void Game::ConfigureSystems() {
+    registry->GetSystem<MovementSystem>().SetFixedPoint(isFixedPointSimulation);
+    registry->GetSystem<TileCollisionSystem>().SetFixedPoint(isFixedPointSimulation);
+    registry->GetSystem<CollisionSystem>().SetFixedPoint(isFixedPointSimulation);
+    registry->GetSystem<NavigationSystem>().SetFixedPoint(isFixedPointSimulation);
+    registry->GetSystem<SteeringSystem>().SetFixedPoint(isFixedPointSimulation);
+}
+
+// Levels share the jungle map and differ in who is on it and where the enemies head
+struct LevelLayout {
+    glm::vec2 playerPosition;
+    glm::vec2 enemyPosition;
+    glm::vec2 enemyDestination;
+    int numEnemies;
+};
+
+static const LevelLayout LEVEL_LAYOUTS[NUM_LEVELS] = {
+    { glm::vec2(10.0, 10.0), glm::vec2(10.0, 10.0), glm::vec2(1700.0, 1300.0), 1 },
+    { glm::vec2(1200.0, 1400.0), glm::vec2(500.0, 100.0), glm::vec2(1800.0, 1450.0), 4 }
+};
+
+// Fills the registry with the level's entities and stages the level's textures; returns the player's entity id
+// Touches nothing but its arguments, so it is safe to run on a worker thread
+int Game::BuildLevel(int level, Registry& registry, AssetStore& assetStore, TileMap& tileMap) {
+    const LevelLayout& layout = LEVEL_LAYOUTS[(level - 1) % NUM_LEVELS];
 
     // Adding assets to the asset store
-    assetStore->AddTexture(renderer, "enemy-character", "./assets/images/EnemyCharacter.png");
-    assetStore->AddTexture(renderer, "player-character", "./assets/images/PlayerCharacter.png");
-    assetStore->AddTexture(renderer, "tilemap-image", "./assets/tilemaps/jungle.png");
+    assetStore.StageTexture("enemy-character", "./assets/images/EnemyCharacter.png");
+    assetStore.StageTexture("player-character", "./assets/images/PlayerCharacter.png");
+    assetStore.StageTexture("tilemap-image", "./assets/tilemaps/jungle.png");
+    assetStore.StageTexture("bullet", "./assets/images/bullet.png");
 
     // Load the tilemap
     int tileSize = 32;
@@ -85,62 +210,349 @@ void Game::LoadLevel(int level) {
     int mapNumCols = 25;
     int mapNumRows = 20;
 
-    std::fstream mapFile;
-    mapFile.open("./assets/tilemaps/jungle.map");
+    // Water (08 to 19 and the 22 shore) and the rocks (27, 28) of the jungle tileset block movement
+    const int solidTileTypes[] = { 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 22, 27, 28 };
+    for (int tileType : solidTileTypes) {
+        TileProperties properties;
+        properties.isSolid = true;
+        tileMap.SetTileProperties(tileType, properties);
+    }
+
+    if (!tileMap.LoadFromFile("./assets/tilemaps/jungle.map", mapNumCols, mapNumRows, static_cast<float>(tileScale * tileSize))) {
+        Logger::Err("Error reading tilemap ./assets/tilemaps/jungle.map");
+    }
 
-    for (int y = 0; y < mapNumRows; y++) {
-        for (int x = 0; x < mapNumCols; x++) {
-            char ch;
-            mapFile.get(ch);
-            int srcRectY = std::atoi(&ch) * tileSize; // atoi - ascii to int
-            mapFile.get(ch);
-            int srcRectX = std::atoi(&ch) * tileSize;
-            mapFile.ignore();
+    // Tiles are drawn as sprites; their collision lives in the tile map alone
+    for (int y = 0; y < tileMap.GetNumRows(); y++) {
+        for (int x = 0; x < tileMap.GetNumCols(); x++) {
+            // The tile type's digits are its row and column in the tileset image
+            const int tileType = tileMap.GetTileType(x, y);
+            int srcRectY = (tileType / 10) * tileSize;
+            int srcRectX = (tileType % 10) * tileSize;
 
-            Entity tile = registry->CreateEntity();
+            Entity tile = registry.CreateEntity();
             tile.AddComponent<TransformComponent>(glm::vec2(x * (tileScale * tileSize), y * (tileScale * tileSize)), glm::vec2(tileScale, tileScale), 0.0);
             tile.AddComponent<SpriteComponent>("tilemap-image", tileSize, tileSize, 0, srcRectX, srcRectY);
         }
     }
 
     // Create an entity & components for that entity
-    Entity enemyCharacter = registry->CreateEntity();
-    enemyCharacter.AddComponent<TransformComponent>(glm::vec2(10.0, 10.0), glm::vec2(1.0, 1.0), 0.0);
-    enemyCharacter.AddComponent<RigidBodyComponent>(glm::vec2(30.0, 0.0));
-    enemyCharacter.AddComponent<SpriteComponent>("enemy-character", 60, 80, 2);
+    for (int i = 0; i < layout.numEnemies; i++) {
+        Entity enemyCharacter = registry.CreateEntity();
+        enemyCharacter.AddComponent<TransformComponent>(layout.enemyPosition + glm::vec2(80.0 * i, 0.0), glm::vec2(1.0, 1.0), 0.0);
+        enemyCharacter.AddComponent<RigidBodyComponent>(glm::vec2(30.0, 0.0));
+        enemyCharacter.AddComponent<SpriteComponent>("enemy-character", 60, 80, 2);
+        enemyCharacter.AddComponent<BoxColliderComponent>(60, 80, glm::vec2(0), COLLISION_LAYER_ENEMY);
+        enemyCharacter.AddComponent<NavigationComponent>(60.0f, layout.enemyDestination, true);
+        enemyCharacter.AddComponent<SteeringComponent>(60.0f);
+    }
 
     // Create another entity & components for that entity
-    Entity playerCharacter = registry->CreateEntity();
-    playerCharacter.AddComponent<TransformComponent>(glm::vec2(10.0, 10.0), glm::vec2(1.0, 1.0), 0.0); 
+    Entity playerCharacter = registry.CreateEntity();
+    playerCharacter.AddComponent<TransformComponent>(layout.playerPosition, glm::vec2(1.0, 1.0), 0.0); 
     playerCharacter.AddComponent<RigidBodyComponent>(glm::vec2(20.0, 0.0)); 
     playerCharacter.AddComponent<SpriteComponent>("player-character", 60, 80, 1);
+    playerCharacter.AddComponent<BoxColliderComponent>(60, 80, glm::vec2(0), COLLISION_LAYER_PLAYER);
+    playerCharacter.AddComponent<ParticleEmitterComponent>("bullet", 40.0f, 0.8f, 10.0f, 30.0f, 180.0f, 60.0f, 6.0f, 2.0f,
+        SDL_Color{ 170, 140, 100, 200 }, SDL_Color{ 120, 100, 80, 0 }, glm::vec2(0.0, -20.0), glm::vec2(0.0, 75.0));
+
+    return playerCharacter.GetId();
+}
+
+// Builds a complete level on its own arena, registry and staging asset store
+Level Game::CreateLevel(int level) {
+    Level newLevel;
+    newLevel.memory = std::make_unique<std::pmr::monotonic_buffer_resource>(LEVEL_MEMORY_SIZE);
+    newLevel.registry = std::make_unique<Registry>(newLevel.memory.get());
+    newLevel.assetStore = std::make_unique<AssetStore>();
+    newLevel.tileMap = std::make_unique<TileMap>();
+
+    AddSystems(*newLevel.registry);
+    newLevel.playerId = BuildLevel(level, *newLevel.registry, *newLevel.assetStore, *newLevel.tileMap);
+
+    // Hand the new entities to the systems now, so the first frame after the swap has nothing to add
+    newLevel.registry->Update();
+
+    return newLevel;
+}
+
+// Start building the level on a worker thread while the current level keeps playing
+void Game::PreloadLevel(int level) {
+    if (preloadedLevel.valid()) {
+        if (preloadedLevelNumber == level) {
+            return;
+        }
+        DiscardPreloadedLevel();
+    }
+    preloadedLevelNumber = level;
+    preloadedLevel = std::async(std::launch::async, &Game::CreateLevel, level);
+}
+
+// Request a level switch; it is applied at the start of the next frame
+void Game::SwitchLevel(int level) {
+    levelToSwitchTo = level;
+}
+
+// Drop the level being preloaded; its worker is left to finish in the background
+void Game::DiscardPreloadedLevel() {
+    if (preloadedLevel.valid()) {
+        Logger::Log("Discarded preloaded level " + std::to_string(preloadedLevelNumber));
+        discardedLevels.push_back(std::move(preloadedLevel));
+        preloadedLevelNumber = 0;
+    }
+}
+
+// Free the discarded levels whose workers have finished
+void Game::ReleaseDiscardedLevels() {
+    for (size_t i = 0; i < discardedLevels.size();) {
+        if (discardedLevels[i].wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            discardedLevels[i] = std::move(discardedLevels.back());
+            discardedLevels.pop_back();
+        } else {
+            i++;
+        }
+    }
+}
+
+// Replace the current level with the preloaded one if the worker has finished
+// Returns false while the level is still being built, so the current level keeps playing
+bool Game::SwapInPreloadedLevel() {
+    if (preloadedLevel.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return false;
+    }
+
+    Level level = preloadedLevel.get();
+
+    // Textures can only be created on the thread that owns the renderer
+    level.assetStore->CommitStagedTextures(renderer);
+
+    // Subscribers belong to the systems of the level being replaced
+    eventBus->ClearSubscribers();
+
+    // Release the old registry before the arena it lives in
+    registry = std::move(level.registry);
+    levelMemory = std::move(level.memory);
+    assetStore = std::move(level.assetStore);
+    tileMap = std::move(level.tileMap);
+    playerId = level.playerId;
+    projectileSystem->Clear();
+    pathRequestQueue->Clear();
+    flowFieldCache->Clear();
+    ConfigureSystems();
+    SubscribeToEvents();
+
+    Logger::Log("Switched to preloaded level " + std::to_string(preloadedLevelNumber));
+    currentLevel = preloadedLevelNumber;
+    preloadedLevelNumber = 0;
+    PreloadLevel(currentLevel % NUM_LEVELS + 1);
+    return true;
+}
+
+void Game::SubscribeToEvents() {
+    eventBus->SubscribeToEvent<KeyPressedEvent>(this, &Game::OnKeyPressed);
+    registry->GetSystem<ParticleSystem>().SubscribeToEvents(*eventBus);
+}
+
+void Game::OnKeyPressed(const std::pmr::vector<KeyPressedEvent>& events) {
+    for (const KeyPressedEvent& event : events) {
+        if (event.symbol == SDLK_n) {
+            SwitchLevel(currentLevel % NUM_LEVELS + 1);
+        }
+        if (event.symbol == SDLK_SPACE) {
+            FirePlayerBullet();
+        }
+    }
+}
 
+// The player shoots from the middle of its box in the direction it is moving
+void Game::FirePlayerBullet() {
+    const Entity player(playerId);
+    const auto& transform = registry->GetComponent<TransformComponent>(player);
+    const auto& collider = registry->GetComponent<BoxColliderComponent>(player);
+    const glm::vec2 velocity = registry->GetComponent<RigidBodyComponent>(player).velocity;
+    const glm::vec2 direction = glm::length(velocity) > 0.0f ? glm::normalize(velocity) : glm::vec2(1.0f, 0.0f);
+    const glm::vec2 center = transform.position + collider.offset + 0.5f * glm::vec2(collider.width, collider.height);
+    projectileSystem->Spawn(center, direction * PLAYER_BULLET_SPEED, PLAYER_BULLET_LIFETIME, COLLISION_LAYER_ENEMY | COLLISION_LAYER_SCENERY, playerId);
+}
+
+// Checksum snapshots are kept next to the input recording they belong to
+static std::string GetSnapshotPath(const std::string& recordingPath) {
+    return recordingPath + ".snapshots";
 }
 
 void Game::Setup() {
+    if (!inputReplayPath.empty()) {
+        inputPlayer = std::make_unique<InputPlayer>();
+        if (!inputPlayer->Open(inputReplayPath)) {
+            Logger::Err("Error reading input recording " + inputReplayPath);
+            isRunning = false;
+        }
+
+        // Replay with the simulation the recording was made with
+        isFixedPointSimulation = inputPlayer->IsFixedPoint();
+
+        // Older recordings have no snapshots; a divergence is then only reported by frame
+        snapshotInput.open(GetSnapshotPath(inputReplayPath), std::ios::binary);
+    } else if (!inputRecordingPath.empty()) {
+        // Recordings are meant to be replayed by other builds, which only the fixed point simulation reproduces
+        isFixedPointSimulation = true;
+        inputRecorder = std::make_unique<InputRecorder>();
+        if (!inputRecorder->Open(inputRecordingPath, isFixedPointSimulation)) {
+            Logger::Err("Error creating input recording " + inputRecordingPath);
+            inputRecorder.reset();
+        } else {
+            snapshotOutput.open(GetSnapshotPath(inputRecordingPath), std::ios::binary);
+            if (!snapshotOutput) {
+                Logger::Err("Error creating checksum snapshots " + GetSnapshotPath(inputRecordingPath));
+            }
+        }
+    }
+
+    AddSystems(*registry);
+    ConfigureSystems();
+    SubscribeToEvents();
     LoadLevel(1);
 }
 
 void Game::Update() {
-    // If we are too fast, waste some time until we reach the MILLISECS_PER_FRAME
-    int timeToWait = MILLISECS_PER_FRAME - (SDL_GetTicks() - millisecsPreviousFrame);
-    if (timeToWait > 0 && timeToWait <= MILLISECS_PER_FRAME) {
-        SDL_Delay(timeToWait);
+    // If we are too fast, wait until the frame's deadline; returns the real time since the last frame in seconds
+    // A replay never waits: it runs the steps each frame ran when it was recorded, as fast as it can
+    const double frameTime = inputPlayer ? 0.0 : framePacer->WaitForNextFrame();
+    const Uint64 frameStart = SDL_GetPerformanceCounter();
+
+    // Level switches happen at the frame boundary, before any system runs
+    if (levelToSwitchTo != 0) {
+        if (preloadedLevel.valid() && preloadedLevelNumber == levelToSwitchTo) {
+            // A replay swaps on the frame the recording did, however long the preload takes this time
+            if (inputPlayer && frameInput.isLevelSwitched) {
+                preloadedLevel.wait();
+            }
+            if ((!inputPlayer || frameInput.isLevelSwitched) && SwapInPreloadedLevel()) {
+                levelToSwitchTo = 0;
+                frameInput.isLevelSwitched = true;
+            }
+        } else {
+            DiscardPreloadedLevel();
+            LoadLevel(levelToSwitchTo);
+            levelToSwitchTo = 0;
+        }
+    }
+    ReleaseDiscardedLevels();
+
+    int steps = 0;
+    if (inputPlayer) {
+        for (; steps < frameInput.numSteps; steps++) {
+            FixedUpdate(FIXED_DELTA_TIME);
+        }
+        VerifyReplayFrame(steps, SDL_GetPerformanceCounter() - frameStart);
+        return;
+    }
+
+    // Run as many fixed simulation steps as the elapsed time calls for
+    timeAccumulator += frameTime;
+    while (timeAccumulator >= FIXED_DELTA_TIME && steps < MAX_SIMULATION_STEPS_PER_FRAME) {
+        FixedUpdate(FIXED_DELTA_TIME);
+        timeAccumulator -= FIXED_DELTA_TIME;
+        steps++;
+    }
+
+    // Spiral-of-death guard: when the simulation falls behind, drop the steps it could not catch up on
+    if (timeAccumulator >= FIXED_DELTA_TIME) {
+        timeAccumulator = std::fmod(timeAccumulator, FIXED_DELTA_TIME);
     }
 
-    // The difference in ticks since the last frame, converted to seconds
-    double deltaTime = (SDL_GetTicks() - millisecsPreviousFrame) / 1000.0;
+    renderInterpolation = timeAccumulator / FIXED_DELTA_TIME;
 
-    // Store the "previous" frame time
-    millisecsPreviousFrame = SDL_GetTicks();
+    if (inputRecorder) {
+        frameInput.numSteps = static_cast<uint8_t>(steps);
+        frameInput.checksum = registry->GetSystem<StateChecksumSystem>().GetChecksum();
+        inputRecorder->RecordFrame(frameInput);
+    }
+    frameNumber++;
+}
+
+void Game::VerifyReplayFrame(int steps, Uint64 frameCounter) {
+    frameProfile.AddFrame(static_cast<double>(frameCounter) / SDL_GetPerformanceFrequency(), steps);
+
+    // A different checksum means this build no longer reproduces the recorded session, so its profile is not comparable
+    if (steps > 0 && !isReplayDiverged && registry->GetSystem<StateChecksumSystem>().GetChecksum() != frameInput.checksum) {
+        Logger::Err("Replay diverged from the recording at frame " + std::to_string(frameNumber));
+        isReplayDiverged = true;
+    }
+    frameNumber++;
+}
+
+// A recording writes the snapshot of this step; a replay reads the recorded one and, the first
+// time the checksums differ, logs the first entity and component whose hashes differ
+void Game::ExchangeChecksumSnapshot() {
+    const auto& stateChecksumSystem = registry->GetSystem<StateChecksumSystem>();
+    if (snapshotOutput.is_open()) {
+        stateChecksumSystem.TakeSnapshot(snapshot);
+        StateChecksumSystem::WriteSnapshot(snapshotOutput, snapshot);
+        return;
+    }
+    if (!snapshotInput.is_open()) {
+        return;
+    }
+    if (!StateChecksumSystem::ReadSnapshot(snapshotInput, recordedSnapshot)) {
+        snapshotInput.close();
+        return;
+    }
+    if (isDivergenceLocated || recordedSnapshot.checksum == stateChecksumSystem.GetChecksum()) {
+        return;
+    }
+    isDivergenceLocated = true;
+    stateChecksumSystem.TakeSnapshot(snapshot);
+    const ChecksumDivergence divergence = StateChecksumSystem::FindFirstDivergence(recordedSnapshot, snapshot);
+    if (divergence.isDiverged) {
+        Logger::Err("Replay state differs at step " + std::to_string(simulationStep) + ": entity " + std::to_string(divergence.entityId) +
+            ", " + StateChecksumSystem::GetComponentName(divergence.component));
+    } else {
+        Logger::Err("Replay checksum differs at step " + std::to_string(simulationStep) + " but no entity's hashes do");
+    }
+}
 
+void Game::FixedUpdate(double deltaTime) {
     // Update the registry to process the entities that are waiting to be created/killed
     registry->Update();
 
+    // Keep the state before this step so rendering can blend towards the new one
+    registry->GetSystem<RenderSystem>().StorePreviousTransforms(*registry);
+
     // Invoke all the systems that need to Update:
-    registry->GetSystem<MovementSystem>().Update(deltaTime);
+    auto& sleepSystem = registry->GetSystem<SleepSystem>();
+    auto& stateChecksumSystem = registry->GetSystem<StateChecksumSystem>();
+    stateChecksumSystem.MarkChanged(sleepSystem.GetAwakeBodies(*registry));
+    // A time budget would answer requests in different steps on every run, so recordings,
+    // replays and the fixed point simulation bound the queue by request count instead
+    if (isFixedPointSimulation || inputRecorder || inputPlayer) {
+        pathRequestQueue->UpdateByCount(*tileMap, *jobSystem, PATHFINDING_REQUESTS_PER_STEP);
+    } else {
+        pathRequestQueue->Update(*tileMap, *jobSystem, PATHFINDING_BUDGET);
+    }
+    flowFieldCache->Update(*tileMap, *jobSystem);
+    registry->GetSystem<NavigationSystem>().Update(*registry, *pathRequestQueue, *flowFieldCache, *tileMap, sleepSystem, deltaTime);
+    registry->GetSystem<SteeringSystem>().Update(*registry, *tileMap, *jobSystem);
+    registry->GetSystem<MovementSystem>().Update(*registry, deltaTime, sleepSystem.GetAwakeBodies(*registry));
+    registry->GetSystem<TileCollisionSystem>().Update(*registry, *tileMap);
+    registry->GetSystem<HierarchySystem>().Update(*registry);
+    registry->GetSystem<CollisionSystem>().Update(*registry, *eventBus);
+    sleepSystem.Update(*registry, registry->GetSystem<CollisionSystem>().GetContacts());
+    projectileSystem->Update(*registry, *eventBus, *tileMap, deltaTime);
+    registry->GetSystem<ParticleSystem>().Update(*registry, deltaTime);
 
-    
+    // Bodies that woke up during the step changed too, as did everything attached to a parent
+    stateChecksumSystem.MarkChanged(sleepSystem.GetAwakeBodies(*registry));
+    stateChecksumSystem.MarkChanged(registry->GetSystem<HierarchySystem>().GetSystemEntities());
+    stateChecksumSystem.Update(*registry, *jobSystem);
+    simulationStep++;
+    if (simulationStep % CHECKSUM_SNAPSHOT_INTERVAL == 0) {
+        ExchangeChecksumSnapshot();
+    }
+
+    // Deliver this step's events to their subscribers in batches, then rewind the event arena
+    eventBus->DispatchEvents();
+    eventBus->Reset();
 }
 
 void Game::Render() {
@@ -148,7 +560,9 @@ void Game::Render() {
     SDL_RenderClear(renderer);
 
     // Invoke all the systems that need to Render:
-    registry->GetSystem<RenderSystem>().Update(renderer, assetStore);
+    registry->GetSystem<RenderSystem>().Update(renderer, assetStore, renderInterpolation);
+    projectileSystem->Render(renderer, *assetStore, renderInterpolation);
+    registry->GetSystem<ParticleSystem>().Render(renderer, *assetStore, renderInterpolation, FIXED_DELTA_TIME);
 
     // TODO: Render game objects...
 
@@ -159,12 +573,45 @@ void Game::Run() {
     Setup();
     while (isRunning) {
         ProcessInput();
+
+        // A replay stops at the end of the recording and draws nothing
+        if (inputPlayer) {
+            if (isRunning) {
+                Update();
+            }
+            continue;
+        }
         Update();
         Render();
     }
 }
 
 void Game::Destroy() {
+    if (inputPlayer) {
+        const FrameProfileSummary profile = frameProfile.GetSummary();
+        Logger::Log("Replay profile: " + std::to_string(profile.frameCount) + " frames, " + std::to_string(profile.stepCount) + " steps in " +
+            std::to_string(profile.totalTime) + " s, average frame = " + std::to_string(profile.averageFrameTime * 1000.0) + " ms, average step = " +
+            std::to_string(profile.averageStepTime * 1000.0) + " ms, median = " + std::to_string(profile.medianFrameTime * 1000.0) + " ms, p95 = " +
+            std::to_string(profile.p95FrameTime * 1000.0) + " ms, p99 = " + std::to_string(profile.p99FrameTime * 1000.0) + " ms, max = " +
+            std::to_string(profile.maxFrameTime * 1000.0) + " ms" + (isReplayDiverged ? " (diverged)" : ""));
+        // The frames of a diverged replay did different work than the recording's, so their times are not comparable
+        if (!frameProfilePath.empty() && isReplayDiverged) {
+            Logger::Err("Replay diverged, not writing frame profile " + frameProfilePath);
+        } else if (!frameProfilePath.empty() && !frameProfile.WriteCsv(frameProfilePath)) {
+            Logger::Err("Error writing frame profile " + frameProfilePath);
+        }
+        SDL_Quit();
+        return;
+    }
+    if (inputRecorder) {
+        inputRecorder->Close();
+        snapshotOutput.close();
+    }
+
+    const FramePacingStats& pacing = framePacer->GetStats();
+    Logger::Log("Frame pacing: " + std::to_string(pacing.frameCount) + " frames, " + std::to_string(pacing.lateFrames) + " late, average miss = " +
+        std::to_string(pacing.averageMiss * 1000.0) + " ms, max miss = " + std::to_string(pacing.maxMiss * 1000.0) + " ms, jitter = " + std::to_string(pacing.jitter * 1000.0) + " ms");
+
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
@@ -2,31 +2,158 @@
 #define GAME_H
 
 #include <SDL.h>
+#include <memory_resource>
+#include <future>
 #include "ECS/ECS.h"
 #include "./AssetManager/AssetStore.h"
+#include "./EventBus/EventBus.h"
+#include "./FramePacer/FramePacer.h"
+#include "./TileMap/TileMap.h"
+#include "./Jobs/JobSystem.h"
+#include "./Projectiles/ProjectileSystem.h"
+#include "./Navigation/PathRequestQueue.h"
+#include "./Navigation/FlowFieldCache.h"
+#include "./Events/KeyPressedEvent.h"
+#include "./Replay/InputRecording.h"
+#include "./Replay/FrameProfile.h"
+#include "./Systems/StateChecksumSystem.h"
+#include <fstream>
+#include <string>
 
 const int FPS = 60;
-const int MILLISECS_PER_FRAME = 1000 / FPS;
+
+// The simulation always advances in steps of FIXED_DELTA_TIME seconds; rendering interpolates between steps
+const double FIXED_DELTA_TIME = 1.0 / FPS;
+
+// Upper bound of simulation steps per rendered frame, so a slow frame cannot make the next one even slower
+const int MAX_SIMULATION_STEPS_PER_FRAME = 5;
+
+// Steps between the checksum snapshots a recording keeps next to its input, so a replay that
+// diverges can tell which entity and component differ first
+const unsigned int CHECKSUM_SNAPSHOT_INTERVAL = 300;
+
+// Bullets that can be alive at once; their storage is allocated when the game starts
+const size_t MAX_PROJECTILES = 50000;
+
+// The player's bullets: speed in pixels per second and lifetime in seconds
+const float PLAYER_BULLET_SPEED = 800.0f;
+const float PLAYER_BULLET_LIFETIME = 1.5f;
+
+// Particles (dust, smoke, explosions) that can be alive at once, across all textures
+const size_t MAX_PARTICLES = 200000;
+
+// Time each simulation step may spend solving queued path requests; the rest wait for the next step
+const double PATHFINDING_BUDGET = 0.002;
+
+// Path requests each step solves instead when the simulation must be deterministic (fixed point,
+// recording or replay), whatever they cost
+const size_t PATHFINDING_REQUESTS_PER_STEP = 32;
+
+// Levels the game cycles through; the next one is preloaded while the current one plays
+const int NUM_LEVELS = 2;
+
+// Size of the first block the level arena requests; sized so the ECS storage
+// normally fits without going back to the heap
+const size_t LEVEL_MEMORY_SIZE = 4 * 1024 * 1024;
+
+// Everything a level owns: the arena, the registry built on it, the level's assets and its tile map
+// A level can be built off the main thread and swapped into the game in one step
+struct Level {
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> memory;
+    std::unique_ptr<Registry> registry;
+    std::unique_ptr<AssetStore> assetStore;
+    std::unique_ptr<TileMap> tileMap;
+    int playerId = -1;
+};
 
 class Game {
 private:
     bool isRunning;
-    int millisecsPreviousFrame = 0;
+    std::unique_ptr<FramePacer> framePacer;
+
+    // Deterministic simulation mode: movement and collision math in Q16.16 fixed point,
+    // path requests bounded by count (as when recording or replaying); navigation, steering and projectiles stay in float
+    bool isFixedPointSimulation = false;
+
+    // Input recording and replay: a replay runs headlessly at full speed and profiles every frame
+    std::string inputRecordingPath;
+    std::string inputReplayPath;
+    std::string frameProfilePath;
+    std::unique_ptr<InputRecorder> inputRecorder;
+    std::unique_ptr<InputPlayer> inputPlayer;
+    FrameInput frameInput;
+    FrameProfile frameProfile;
+    unsigned int frameNumber = 0;
+    bool isReplayDiverged = false;
+
+    // Checksum snapshots, written by a recording and compared by a replay every CHECKSUM_SNAPSHOT_INTERVAL steps
+    std::ofstream snapshotOutput;
+    std::ifstream snapshotInput;
+    ChecksumSnapshot snapshot;
+    ChecksumSnapshot recordedSnapshot;
+    unsigned int simulationStep = 0;
+    bool isDivergenceLocated = false;
+
+    // Simulation time not yet consumed by fixed steps, and the resulting blend factor for rendering
+    double timeAccumulator = 0.0;
+    double renderInterpolation = 1.0;
     SDL_Window* window;
     SDL_Renderer* renderer;
 
+    // Arena holding every ECS allocation, kept warm across level switches
+    // (declared before the registry so the registry is destroyed first)
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> levelMemory;
     std::unique_ptr<Registry> registry;
     std::unique_ptr<AssetStore> assetStore;
+    std::unique_ptr<EventBus> eventBus;
+    std::unique_ptr<TileMap> tileMap;
+    int playerId = -1;
+
+    // Worker threads shared by the systems that split their work into jobs
+    std::unique_ptr<JobSystem> jobSystem;
+
+    std::unique_ptr<ProjectileSystem> projectileSystem;
+    std::unique_ptr<PathRequestQueue> pathRequestQueue;
+    std::unique_ptr<FlowFieldCache> flowFieldCache;
+
+    // Next level being built on a worker thread, and the level the game should switch to
+    std::future<Level> preloadedLevel;
+    int preloadedLevelNumber = 0;
+    int levelToSwitchTo = 0;
+    int currentLevel = 0;
+
+    // Preloads that are no longer wanted, kept until their worker finishes so dropping them never blocks a frame
+    std::vector<std::future<Level>> discardedLevels;
+
+    static void AddSystems(Registry& registry);
+    void ConfigureSystems();
+    static int BuildLevel(int level, Registry& registry, AssetStore& assetStore, TileMap& tileMap);
+    static Level CreateLevel(int level);
+    bool SwapInPreloadedLevel();
+    void DiscardPreloadedLevel();
+    void ReleaseDiscardedLevels();
+    void SubscribeToEvents();
+    void OnKeyPressed(const std::pmr::vector<KeyPressedEvent>& events);
+    void FirePlayerBullet();
+    void VerifyReplayFrame(int steps, Uint64 frameCounter);
+    void ExchangeChecksumSnapshot();
 
 public:
     Game();
     ~Game();
     void Initialize();
+    void SetFixedPointSimulation(bool isFixedPoint);
+    void RecordInput(const std::string& filePath);
+    void ReplayInput(const std::string& filePath, const std::string& profilePath);
     void Run();
     void Setup();
     void LoadLevel(int level);
+    void UnloadLevel();
+    void PreloadLevel(int level);
+    void SwitchLevel(int level);
     void ProcessInput();
     void Update();
+    void FixedUpdate(double deltaTime);
     void Render();
     void Destroy();
 
@@ -0,0 +1,64 @@
+#include "JobSystem.h"
+
+JobSystem::JobSystem(int numWorkers) {
+	if (numWorkers <= 0) {
+		const int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+		numWorkers = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+	}
+	for (int i = 0; i < numWorkers; i++) {
+		workers.emplace_back(&JobSystem::WorkerLoop, this);
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		isStopping = true;
+	}
+	jobAvailable.notify_all();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+int JobSystem::GetNumThreads() const {
+	return static_cast<int>(workers.size()) + 1;
+}
+
+void JobSystem::Submit(std::function<void()> job) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+	jobAvailable.notify_one();
+}
+
+bool JobSystem::RunPendingJob() {
+	std::function<void()> job;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (jobs.empty()) {
+			return false;
+		}
+		job = std::move(jobs.front());
+		jobs.pop_front();
+	}
+	job();
+	return true;
+}
+
+void JobSystem::WorkerLoop() {
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobAvailable.wait(lock, [this]() { return isStopping || !jobs.empty(); });
+			if (isStopping && jobs.empty()) {
+				return;
+			}
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		job();
+	}
+}
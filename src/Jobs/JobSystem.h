@@ -0,0 +1,94 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//*************************************************************************************
+// JOB SYSTEM
+// A fixed pool of worker threads fed from one job queue. Submit queues a job to run
+// later; ParallelFor splits a range into batches that the workers and the calling thread
+// take in turn, and returns once every batch is done.
+// A thread that waits on the job system runs queued jobs meanwhile, so jobs may
+// themselves call ParallelFor without deadlocking the pool.
+//*************************************************************************************
+
+class JobSystem {
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+	std::mutex mutex;
+	std::condition_variable jobAvailable;
+	bool isStopping = false;
+
+	void WorkerLoop();
+
+	// Runs one queued job on the calling thread; returns false if the queue was empty
+	bool RunPendingJob();
+
+public:
+	// Zero worker threads means one per hardware thread besides the calling one
+	JobSystem(int numWorkers = 0);
+	~JobSystem();
+
+	// Number of threads that take part in a ParallelFor (the workers plus the caller)
+	int GetNumThreads() const;
+
+	void Submit(std::function<void()> job);
+
+	// Calls body(begin, end) over [0, count) in batches of at most batchSize items
+	template <typename TBody> void ParallelFor(size_t count, size_t batchSize, TBody&& body);
+};
+
+template <typename TBody>
+void JobSystem::ParallelFor(size_t count, size_t batchSize, TBody&& body) {
+	if (count == 0) {
+		return;
+	}
+	batchSize = batchSize > 0 ? batchSize : 1;
+	const size_t numBatches = (count + batchSize - 1) / batchSize;
+	if (numBatches == 1 || workers.empty()) {
+		body(size_t(0), count);
+		return;
+	}
+
+	// Lives on this stack frame; the helpers hold a pointer, so it must outlive every helper
+	struct Work {
+		std::atomic<size_t> nextBatch{ 0 };
+		std::atomic<int> activeHelpers{ 0 };
+	} work;
+
+	auto runBatches = [&]() {
+		for (size_t batch = work.nextBatch++; batch < numBatches; batch = work.nextBatch++) {
+			const size_t begin = batch * batchSize;
+			const size_t end = (begin + batchSize < count) ? begin + batchSize : count;
+			body(begin, end);
+		}
+	};
+
+	const int numHelpers = static_cast<int>(std::min(workers.size(), numBatches - 1));
+	work.activeHelpers = numHelpers;
+	for (int i = 0; i < numHelpers; i++) {
+		Submit([&work, &runBatches]() {
+			runBatches();
+			work.activeHelpers--;
+		});
+	}
+
+	runBatches();
+
+	// Every batch has been taken; wait for the helpers still finishing theirs
+	while (work.activeHelpers > 0) {
+		if (!RunPendingJob()) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+#endif
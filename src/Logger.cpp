@@ -3,9 +3,13 @@
 #include <string>
 #include <chrono>
 #include <ctime>
+#include <mutex>
 
 std::vector<LogEntry> Logger::messages;
 
+// Levels can be built on a worker thread, so log calls may come from more than one thread
+static std::mutex loggerMutex;
+
 std::string CurrentDateTimeToString() {
     std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
     std::string output(30, '\0');
@@ -19,6 +23,7 @@ void Logger::Log(const std::string& message) {
     LogEntry logEntry;
     logEntry.type = LOG_INFO;
     logEntry.message = "LOG: [" + CurrentDateTimeToString() + "]: " + message;
+    std::lock_guard<std::mutex> lock(loggerMutex);
     std::cout << "\x1B[32m" << logEntry.message << "\033[0m" << std::endl;
     messages.push_back(logEntry);
 }
@@ -27,6 +32,7 @@ void Logger::Err(const std::string& message) {
     LogEntry logEntry;
     logEntry.type = LOG_ERROR;
     logEntry.message = "ERR: [" + CurrentDateTimeToString() + "]: " + message;
+    std::lock_guard<std::mutex> lock(loggerMutex);
     messages.push_back(logEntry);
     std::cerr << "\x1B[91m" << logEntry.message << "\033[0m" << std::endl;
 }
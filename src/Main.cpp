@@ -1,8 +1,39 @@
 #include "Game.h"
+#include "./Benchmarks/Benchmarks.h"
+#include <cstring>
+#include <string>
 
 int main(int argc, char* argv[]) {
+    // --benchmark <name>: run a benchmark (or all of them) instead of the game
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--benchmark") == 0) {
+            return RunBenchmarks(i + 1 < argc ? argv[i + 1] : "all") ? 0 : 1;
+        }
+    }
+
     Game game;
 
+    // --fixed-point: deterministic simulation (fixed point movement and collision math)
+    // --record <file>: record the session's input (in fixed point), with checksum snapshots in <file>.snapshots
+    // --replay <file>: replay a recording headlessly at full speed and profile its frames
+    // --profile <file>: with --replay, write the frame times as CSV, to compare against another build (not if it diverged)
+    std::string replayPath;
+    std::string profilePath;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--fixed-point") == 0) {
+            game.SetFixedPointSimulation(true);
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            game.RecordInput(argv[++i]);
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profilePath = argv[++i];
+        }
+    }
+    if (!replayPath.empty()) {
+        game.ReplayInput(replayPath, profilePath);
+    }
+
     game.Initialize();
     game.Run();
     game.Destroy();
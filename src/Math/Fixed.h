@@ -0,0 +1,148 @@
+#ifndef FIXED_H
+#define FIXED_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+
+//*************************************************************************************
+// FIXED POINT
+// Q16.16 numbers: a 32 bit integer counting 1/65536ths, so values from -32768 to just
+// under 32768. Every operation is integer arithmetic with one defined rounding, so the
+// results are the same bits on every compiler and CPU, unlike float code that a compiler
+// may contract into fused multiply-adds or keep in wider registers.
+// Every result goes through 64 bits and saturates when it does not fit, as do converted
+// values; products and quotients round towards negative infinity.
+// Converting from float rounds to the nearest 1/65536 and converting back rounds to the
+// nearest float, so simulation state kept in floats passes through it deterministically.
+// The fixed-point simulation mode covers movement, tile collision, the collision
+// system's swept tests and the velocities set by navigation and steering. Projectiles
+// still compute in float, so they only repeat exactly on the same build and CPU; in that
+// mode path requests are bounded per step by count rather than by time.
+//*************************************************************************************
+
+struct Fixed {
+	static const int FRACTION_BITS = 16;
+	static const int32_t ONE = 1 << FRACTION_BITS;
+
+	int32_t raw = 0;
+
+	Fixed() = default;
+	explicit Fixed(int value) : raw(value * ONE) {}
+	explicit Fixed(float value) : raw(RoundToRaw(static_cast<double>(value) * ONE)) {}
+	explicit Fixed(double value) : raw(RoundToRaw(value * ONE)) {}
+
+	// Nearest integer, halves away from zero; the remainder of the truncation is exact, so no library rounding is needed
+	// Values out of range saturate like quotients, NaN becomes zero
+	static int32_t RoundToRaw(double scaled) {
+		if (scaled >= static_cast<double>(std::numeric_limits<int32_t>::max())) {
+			return std::numeric_limits<int32_t>::max();
+		}
+		if (scaled <= static_cast<double>(std::numeric_limits<int32_t>::min())) {
+			return std::numeric_limits<int32_t>::min();
+		}
+		if (scaled != scaled) {
+			return 0;
+		}
+		int64_t truncated = static_cast<int64_t>(scaled);
+		const double remainder = scaled - static_cast<double>(truncated);
+		if (remainder >= 0.5) {
+			truncated++;
+		} else if (remainder <= -0.5) {
+			truncated--;
+		}
+		return static_cast<int32_t>(truncated);
+	}
+
+	// Largest integer whose square is not above value, by the bit-by-bit method
+	static uint64_t SqrtInteger(uint64_t value) {
+		uint64_t result = 0;
+		uint64_t bit = uint64_t(1) << 62;
+		while (bit > value) {
+			bit >>= 2;
+		}
+		while (bit != 0) {
+			if (value >= result + bit) {
+				value -= result + bit;
+				result = (result >> 1) + bit;
+			} else {
+				result >>= 1;
+			}
+			bit >>= 2;
+		}
+		return result;
+	}
+
+	static Fixed FromRaw(int32_t raw) {
+		Fixed fixed;
+		fixed.raw = raw;
+		return fixed;
+	}
+
+	// Clamps a 64 bit result to the range of raw values
+	static Fixed Saturate(int64_t raw) {
+		if (raw > std::numeric_limits<int32_t>::max()) {
+			return FromRaw(std::numeric_limits<int32_t>::max());
+		}
+		if (raw < std::numeric_limits<int32_t>::min()) {
+			return FromRaw(std::numeric_limits<int32_t>::min());
+		}
+		return FromRaw(static_cast<int32_t>(raw));
+	}
+
+	float ToFloat() const { return static_cast<float>(raw) * (1.0f / ONE); }
+
+	// Largest integer not above the value
+	int Floor() const { return raw >> FRACTION_BITS; }
+	int Ceil() const { return (raw + ONE - 1) >> FRACTION_BITS; }
+
+	Fixed operator-() const { return Saturate(-static_cast<int64_t>(raw)); }
+	Fixed operator+(Fixed other) const { return Saturate(static_cast<int64_t>(raw) + other.raw); }
+	Fixed operator-(Fixed other) const { return Saturate(static_cast<int64_t>(raw) - other.raw); }
+	Fixed operator*(Fixed other) const { return Saturate((static_cast<int64_t>(raw) * other.raw) >> FRACTION_BITS); }
+	Fixed operator/(Fixed other) const {
+		const int64_t numerator = static_cast<int64_t>(raw) * ONE;
+		int64_t quotient = numerator / other.raw;
+		if (numerator % other.raw != 0 && ((numerator < 0) != (other.raw < 0))) {
+			quotient--;		// integer division truncates towards zero
+		}
+		return Saturate(quotient);
+	}
+	Fixed& operator+=(Fixed other) { return *this = *this + other; }
+	Fixed& operator-=(Fixed other) { return *this = *this - other; }
+
+	bool operator==(Fixed other) const { return raw == other.raw; }
+	bool operator!=(Fixed other) const { return raw != other.raw; }
+	bool operator<(Fixed other) const { return raw < other.raw; }
+	bool operator<=(Fixed other) const { return raw <= other.raw; }
+	bool operator>(Fixed other) const { return raw > other.raw; }
+	bool operator>=(Fixed other) const { return raw >= other.raw; }
+};
+
+struct FixedVec2 {
+	Fixed x;
+	Fixed y;
+
+	FixedVec2() = default;
+	FixedVec2(Fixed x, Fixed y) : x(x), y(y) {}
+	explicit FixedVec2(glm::vec2 value) : x(value.x), y(value.y) {}
+
+	glm::vec2 ToVec2() const { return glm::vec2(x.ToFloat(), y.ToFloat()); }
+
+	Fixed& operator[](int axis) { return axis == 0 ? x : y; }
+	Fixed operator[](int axis) const { return axis == 0 ? x : y; }
+
+	FixedVec2 operator+(FixedVec2 other) const { return FixedVec2(x + other.x, y + other.y); }
+	FixedVec2 operator-(FixedVec2 other) const { return FixedVec2(x - other.x, y - other.y); }
+	FixedVec2 operator*(Fixed scalar) const { return FixedVec2(x * scalar, y * scalar); }
+	FixedVec2 operator/(Fixed scalar) const { return FixedVec2(x / scalar, y / scalar); }
+
+	// Rounded down; the squares are summed in 64 bits, so no length in range overflows
+	Fixed Length() const {
+		const uint64_t squared = static_cast<uint64_t>(static_cast<int64_t>(x.raw) * x.raw) + static_cast<uint64_t>(static_cast<int64_t>(y.raw) * y.raw);
+		const uint64_t length = Fixed::SqrtInteger(squared);
+		return Fixed::FromRaw(length > static_cast<uint64_t>(std::numeric_limits<int32_t>::max()) ? std::numeric_limits<int32_t>::max() : static_cast<int32_t>(length));
+	}
+};
+
+#endif
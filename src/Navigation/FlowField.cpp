@@ -0,0 +1,98 @@
+#include "FlowField.h"
+#include <algorithm>
+#include <cmath>
+
+static const float DIAGONAL_COST = 1.41421356f;
+static const float DIAGONAL = 0.70710678f;
+
+// The 8 moves; a tile's direction is the index of the move towards the goal
+static const int STEP_COLS[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+static const int STEP_ROWS[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+static const glm::vec2 STEP_DIRECTIONS[8] = {
+	{ 1.0f, 0.0f }, { -1.0f, 0.0f }, { 0.0f, 1.0f }, { 0.0f, -1.0f },
+	{ DIAGONAL, DIAGONAL }, { DIAGONAL, -DIAGONAL }, { -DIAGONAL, DIAGONAL }, { -DIAGONAL, -DIAGONAL }
+};
+static const uint8_t OPPOSITE_STEP[8] = { 1, 0, 3, 2, 7, 6, 5, 4 };
+
+void FlowField::Build(const TileMap& tileMap, TileCoord goal) {
+	numCols = tileMap.GetNumCols();
+	numRows = tileMap.GetNumRows();
+	tileSize = tileMap.GetTileSize();
+	this->goal = goal;
+	mapVersion = tileMap.GetVersion();
+	isBuilt = true;
+
+	const size_t numTiles = static_cast<size_t>(numCols) * numRows;
+	integration.assign(numTiles, -1.0f);
+	directions.assign(numTiles, NO_DIRECTION);
+	heap.clear();
+	if (goal.col < 0 || goal.row < 0 || goal.col >= numCols || goal.row >= numRows || tileMap.IsSolid(goal.col, goal.row)) {
+		return;
+	}
+
+	// Tiles still in the open list hold a negative tentative cost below -1, so a settled
+	// tile (cost >= 0) and an untouched one (-1) need no extra arrays
+	auto isOpenTile = [&](int col, int row) {
+		return col >= 0 && row >= 0 && col < numCols && row < numRows && !tileMap.IsSolid(col, row);
+	};
+
+	const int goalTile = goal.row * numCols + goal.col;
+	integration[goalTile] = -2.0f;
+	heap.push_back({ 0.0f, goalTile });
+
+	while (!heap.empty()) {
+		std::pop_heap(heap.begin(), heap.end(), IsLowerPriority);
+		const HeapEntry entry = heap.back();
+		heap.pop_back();
+		if (integration[entry.tile] >= 0.0f) {
+			continue;	// stale entry of a tile settled more cheaply
+		}
+		integration[entry.tile] = entry.cost;
+
+		const int col = entry.tile % numCols;
+		const int row = entry.tile / numCols;
+		for (int i = 0; i < 8; i++) {
+			const int nextCol = col + STEP_COLS[i];
+			const int nextRow = row + STEP_ROWS[i];
+			if (!isOpenTile(nextCol, nextRow)) {
+				continue;
+			}
+			const bool isDiagonal = i >= 4;
+			if (isDiagonal && (!isOpenTile(nextCol, row) || !isOpenTile(col, nextRow))) {
+				continue;
+			}
+
+			const int next = nextRow * numCols + nextCol;
+			const float nextCost = entry.cost + (isDiagonal ? DIAGONAL_COST : 1.0f);
+			const float tentative = integration[next];
+			if (tentative >= 0.0f || (tentative < -1.0f && -tentative - 2.0f <= nextCost)) {
+				continue;
+			}
+			integration[next] = -nextCost - 2.0f;
+			directions[next] = OPPOSITE_STEP[i];
+			heap.push_back({ nextCost, next });
+			std::push_heap(heap.begin(), heap.end(), IsLowerPriority);
+		}
+	}
+}
+
+bool FlowField::IsBuiltFor(const TileMap& tileMap) const {
+	return isBuilt && mapVersion == tileMap.GetVersion() && numCols == tileMap.GetNumCols() && numRows == tileMap.GetNumRows();
+}
+
+float FlowField::GetCost(int col, int row) const {
+	if (col < 0 || row < 0 || col >= numCols || row >= numRows) {
+		return -1.0f;
+	}
+	return integration[row * numCols + col];
+}
+
+glm::vec2 FlowField::GetDirection(glm::vec2 position) const {
+	const int col = static_cast<int>(std::floor(position.x / tileSize));
+	const int row = static_cast<int>(std::floor(position.y / tileSize));
+	if (col < 0 || row < 0 || col >= numCols || row >= numRows) {
+		return glm::vec2(0.0f);
+	}
+	const uint8_t direction = directions[row * numCols + col];
+	return direction == NO_DIRECTION ? glm::vec2(0.0f) : STEP_DIRECTIONS[direction];
+}
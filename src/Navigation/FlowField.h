@@ -0,0 +1,56 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include "TilePathfinder.h"
+#include "../TileMap/TileMap.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+//*************************************************************************************
+// FLOW FIELD
+// Paths from every tile of the map to one goal tile at once. The integration field holds
+// each open tile's path cost to the goal, found by one Dijkstra search outwards from the
+// goal with the same 8-connected moves as the TilePathfinder. The direction field holds,
+// for each tile, the step towards the neighbour it was reached from, so a unit anywhere
+// on the map finds its way with a single lookup, however many units share the goal.
+//*************************************************************************************
+
+class FlowField {
+public:
+	static constexpr uint8_t NO_DIRECTION = 255;
+
+private:
+	struct HeapEntry {
+		float cost;
+		int tile;
+	};
+
+	// Heap order: the entry with the lowest cost is on top
+	static bool IsLowerPriority(const HeapEntry& a, const HeapEntry& b) { return a.cost > b.cost; }
+
+	int numCols = 0;
+	int numRows = 0;
+	float tileSize = 1.0f;
+	TileCoord goal = { -1, -1 };
+	unsigned int mapVersion = 0;
+	bool isBuilt = false;
+
+	std::vector<float> integration;		// [index = row * numCols + col] cost to the goal, -1 if unreachable
+	std::vector<uint8_t> directions;	// [index = row * numCols + col] step towards the goal, NO_DIRECTION at the goal or if unreachable
+	std::vector<HeapEntry> heap;
+
+public:
+	FlowField() = default;
+
+	void Build(const TileMap& tileMap, TileCoord goal);
+	bool IsBuiltFor(const TileMap& tileMap) const;
+
+	TileCoord GetGoal() const { return goal; }
+	float GetCost(int col, int row) const;
+
+	// Unit direction towards the goal from a world position; zero at the goal tile, on unreachable tiles and off the map
+	glm::vec2 GetDirection(glm::vec2 position) const;
+};
+
+#endif
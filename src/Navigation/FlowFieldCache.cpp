@@ -0,0 +1,66 @@
+#include "FlowFieldCache.h"
+
+FlowFieldCache::FlowFieldCache(size_t capacity) {
+	this->capacity = capacity > 0 ? capacity : 1;
+}
+
+const FlowField* FlowFieldCache::GetField(const TileMap& tileMap, TileCoord goal) {
+	Entry* entry = nullptr;
+	for (Entry& candidate : entries) {
+		if (candidate.goal == goal) {
+			entry = &candidate;
+			break;
+		}
+	}
+
+	if (!entry) {
+		if (entries.size() < capacity) {
+			entries.push_back({ std::make_unique<FlowField>(), goal, false, step });
+			entry = &entries.back();
+		} else {
+			// Replace the field unused the longest, unless every field is in use this step
+			Entry* oldest = &entries[0];
+			for (Entry& candidate : entries) {
+				if (candidate.lastUsedStep < oldest->lastUsedStep) {
+					oldest = &candidate;
+				}
+			}
+			if (oldest->lastUsedStep == step) {
+				return nullptr;
+			}
+			entry = oldest;
+			entry->goal = goal;
+			entry->isRequested = false;
+		}
+	}
+
+	entry->lastUsedStep = step;
+	if (entry->goal == entry->field->GetGoal() && entry->field->IsBuiltFor(tileMap)) {
+		return entry->field.get();
+	}
+	entry->isRequested = true;
+	return nullptr;
+}
+
+void FlowFieldCache::Update(const TileMap& tileMap, JobSystem& jobSystem) {
+	entriesToBuild.clear();
+	for (size_t i = 0; i < entries.size(); i++) {
+		if (entries[i].isRequested) {
+			entries[i].isRequested = false;
+			entriesToBuild.push_back(i);
+		}
+	}
+
+	jobSystem.ParallelFor(entriesToBuild.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			Entry& entry = entries[entriesToBuild[i]];
+			entry.field->Build(tileMap, entry.goal);
+		}
+	});
+	step++;
+}
+
+void FlowFieldCache::Clear() {
+	entries.clear();
+	step = 0;
+}
@@ -0,0 +1,45 @@
+#ifndef FLOWFIELDCACHE_H
+#define FLOWFIELDCACHE_H
+
+#include "FlowField.h"
+#include "../TileMap/TileMap.h"
+#include "../Jobs/JobSystem.h"
+#include <memory>
+#include <vector>
+
+//*************************************************************************************
+// FLOW FIELD CACHE
+// Flow fields by goal tile. Asking for a goal that has no current field queues the field
+// for the next Update, which builds every queued field in parallel, one job per field.
+// Fields stay until the tile map changes, when the ones still asked for are rebuilt.
+// The cache holds at most capacity fields; a new goal replaces the field that has gone
+// unused the longest, keeping its memory.
+//*************************************************************************************
+
+class FlowFieldCache {
+private:
+	struct Entry {
+		std::unique_ptr<FlowField> field;
+		TileCoord goal;
+		bool isRequested;
+		unsigned int lastUsedStep;
+	};
+
+	std::vector<Entry> entries;
+	std::vector<size_t> entriesToBuild;
+	size_t capacity;
+	unsigned int step = 0;
+
+public:
+	FlowFieldCache(size_t capacity = 8);
+
+	// The current field for goal, or null while it is being built (or the cache is full of fields in use)
+	const FlowField* GetField(const TileMap& tileMap, TileCoord goal);
+
+	// Builds the fields asked for since the last Update
+	void Update(const TileMap& tileMap, JobSystem& jobSystem);
+
+	void Clear();
+};
+
+#endif
@@ -0,0 +1,356 @@
+#include "HierarchicalPathfinder.h"
+#include <algorithm>
+#include <cstdlib>
+
+// Entrances at least this long get a transition at each end instead of one in the middle
+static const int LONG_ENTRANCE_LENGTH = 6;
+
+// Clusters whose inner paths one job finds while building
+static const size_t BUILD_BATCH_SIZE = 4;
+
+int HierarchicalPathfinder::GetCluster(TileCoord tile) const {
+	return (tile.row / CLUSTER_SIZE) * numClusterCols + tile.col / CLUSTER_SIZE;
+}
+
+TileBounds HierarchicalPathfinder::GetClusterBounds(const TileMap& tileMap, int cluster) const {
+	TileBounds bounds;
+	bounds.col0 = (cluster % numClusterCols) * CLUSTER_SIZE;
+	bounds.row0 = (cluster / numClusterCols) * CLUSTER_SIZE;
+	bounds.col1 = std::min(bounds.col0 + CLUSTER_SIZE, tileMap.GetNumCols()) - 1;
+	bounds.row1 = std::min(bounds.row0 + CLUSTER_SIZE, tileMap.GetNumRows()) - 1;
+	return bounds;
+}
+
+int HierarchicalPathfinder::AddTransitionNode(const TileMap& tileMap, TileCoord tile) {
+	int& node = nodeOfTile[tile.row * tileMap.GetNumCols() + tile.col];
+	if (node < 0) {
+		node = static_cast<int>(nodes.size());
+		nodes.push_back({ tile, GetCluster(tile), -1 });
+	}
+	return node;
+}
+
+void HierarchicalPathfinder::AddEntrances(const TileMap& tileMap, std::vector<std::pair<int, int>>& interEdges) {
+	const int numCols = tileMap.GetNumCols();
+	const int numRows = tileMap.GetNumRows();
+
+	// Walks one border: position i of the border pairs tile sideA(i) with tile sideB(i)
+	auto addBorder = [&](int length, TileCoord firstA, TileCoord firstB, int stepCol, int stepRow) {
+		int runStart = -1;
+		for (int i = 0; i <= length; i++) {
+			const TileCoord a = { firstA.col + stepCol * i, firstA.row + stepRow * i };
+			const TileCoord b = { firstB.col + stepCol * i, firstB.row + stepRow * i };
+			const bool isOpen = i < length && !tileMap.IsSolid(a.col, a.row) && !tileMap.IsSolid(b.col, b.row);
+			if (isOpen && runStart < 0) {
+				runStart = i;
+			} else if (!isOpen && runStart >= 0) {
+				const int runEnd = i - 1;
+				int transitions[2] = { (runStart + runEnd) / 2, -1 };
+				if (runEnd - runStart + 1 >= LONG_ENTRANCE_LENGTH) {
+					transitions[0] = runStart;
+					transitions[1] = runEnd;
+				}
+				for (int t : transitions) {
+					if (t < 0) {
+						continue;
+					}
+					const int nodeA = AddTransitionNode(tileMap, { firstA.col + stepCol * t, firstA.row + stepRow * t });
+					const int nodeB = AddTransitionNode(tileMap, { firstB.col + stepCol * t, firstB.row + stepRow * t });
+					interEdges.push_back({ nodeA, nodeB });
+				}
+				runStart = -1;
+			}
+		}
+	};
+
+	for (int clusterRow = 0; clusterRow < numClusterRows; clusterRow++) {
+		for (int clusterCol = 0; clusterCol < numClusterCols; clusterCol++) {
+			const int col0 = clusterCol * CLUSTER_SIZE;
+			const int row0 = clusterRow * CLUSTER_SIZE;
+
+			// Border with the cluster to the right
+			if (clusterCol + 1 < numClusterCols) {
+				const int length = std::min(CLUSTER_SIZE, numRows - row0);
+				addBorder(length, { col0 + CLUSTER_SIZE - 1, row0 }, { col0 + CLUSTER_SIZE, row0 }, 0, 1);
+			}
+			// Border with the cluster below
+			if (clusterRow + 1 < numClusterRows) {
+				const int length = std::min(CLUSTER_SIZE, numCols - col0);
+				addBorder(length, { col0, row0 + CLUSTER_SIZE - 1 }, { col0, row0 + CLUSTER_SIZE }, 1, 0);
+			}
+		}
+	}
+}
+
+// Marks the clusters holding a tile whose solidity differs from the last build; all of them
+// when there was no build of this map at this size
+void HierarchicalPathfinder::FindChangedClusters(const TileMap& tileMap, std::vector<bool>& isClusterChanged) {
+	const int numCols = tileMap.GetNumCols();
+	const int numRows = tileMap.GetNumRows();
+	const size_t numTiles = static_cast<size_t>(numCols) * numRows;
+	const bool isSameMap = builtFor == &tileMap && numMapCols == numCols && builtSolid.size() == numTiles;
+	isClusterChanged.assign(numClusterCols * numClusterRows, !isSameMap);
+	builtSolid.resize(numTiles);
+	for (int row = 0; row < numRows; row++) {
+		for (int col = 0; col < numCols; col++) {
+			const bool isSolid = tileMap.IsSolid(col, row);
+			if (builtSolid[row * numCols + col] != isSolid) {
+				builtSolid[row * numCols + col] = isSolid;
+				isClusterChanged[GetCluster({ col, row })] = true;
+			}
+		}
+	}
+}
+
+void HierarchicalPathfinder::Build(const TileMap& tileMap, JobSystem& jobSystem) {
+	const int numCols = tileMap.GetNumCols();
+	const int numRows = tileMap.GetNumRows();
+	numClusterCols = (numCols + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	numClusterRows = (numRows + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	const int numClusters = numClusterCols * numClusterRows;
+
+	std::vector<bool> isClusterChanged;
+	FindChangedClusters(tileMap, isClusterChanged);
+
+	// Entrances only cost a walk along the borders, so they are always found again
+	const std::vector<int> previousOffsets = std::move(clusterNodeOffsets);
+	const std::vector<TileCoord> previousNodes = std::move(clusterNodes);
+	nodes.clear();
+	nodeOfTile.assign(static_cast<size_t>(numCols) * numRows, -1);
+	std::vector<std::pair<int, int>> interEdges;
+	AddEntrances(tileMap, interEdges);
+	const int numNodes = static_cast<int>(nodes.size());
+
+	// Group the nodes by cluster
+	clusterNodeOffsets.assign(numClusters + 1, 0);
+	for (const Node& node : nodes) {
+		clusterNodeOffsets[node.cluster + 1]++;
+	}
+	for (int c = 0; c < numClusters; c++) {
+		clusterNodeOffsets[c + 1] += clusterNodeOffsets[c];
+	}
+	clusterNodes.resize(numNodes);
+	std::vector<int> fill(clusterNodeOffsets.begin(), clusterNodeOffsets.end() - 1);
+	for (Node& node : nodes) {
+		node.indexInCluster = fill[node.cluster] - clusterNodeOffsets[node.cluster];
+		clusterNodes[fill[node.cluster]++] = node.tile;
+	}
+
+	// A cluster keeps its costs when neither its tiles nor its transition tiles changed
+	// (a neighbour's change can move the transitions on a shared border)
+	clusterCosts.resize(numClusters);
+	std::vector<int> clustersToSearch;
+	for (int c = 0; c < numClusters; c++) {
+		const int first = clusterNodeOffsets[c];
+		const int count = clusterNodeOffsets[c + 1] - first;
+		const bool isSameNodes = !isClusterChanged[c] && static_cast<int>(previousOffsets.size()) == numClusters + 1 &&
+			previousOffsets[c + 1] - previousOffsets[c] == count &&
+			std::equal(clusterNodes.begin() + first, clusterNodes.begin() + first + count, previousNodes.begin() + previousOffsets[c]);
+		if (!isSameNodes) {
+			clustersToSearch.push_back(c);
+		}
+	}
+
+	// Inner paths: every cluster writes only its own costs
+	jobSystem.ParallelFor(clustersToSearch.size(), BUILD_BATCH_SIZE, [&](size_t begin, size_t end) {
+		TilePathfinder tilePathfinder;
+		for (size_t k = begin; k < end; k++) {
+			const int c = clustersToSearch[k];
+			const int first = clusterNodeOffsets[c];
+			const int count = clusterNodeOffsets[c + 1] - first;
+			const TileBounds bounds = GetClusterBounds(tileMap, c);
+			std::vector<float>& costs = clusterCosts[c];
+			costs.resize(static_cast<size_t>(count) * count);
+			for (int i = 0; i < count; i++) {
+				tilePathfinder.FindCosts(tileMap, clusterNodes[first + i], bounds, &clusterNodes[first], count, &costs[i * count]);
+			}
+		}
+	});
+
+	std::vector<std::vector<Edge>> nodeEdges(numNodes);
+	for (int c = 0; c < numClusters; c++) {
+		const int first = clusterNodeOffsets[c];
+		const int count = clusterNodeOffsets[c + 1] - first;
+		const std::vector<float>& costs = clusterCosts[c];
+		for (int i = 0; i < count; i++) {
+			const TileCoord& tile = clusterNodes[first + i];
+			auto& edgeList = nodeEdges[nodeOfTile[tile.row * numCols + tile.col]];
+			for (int j = 0; j < count; j++) {
+				if (j != i && costs[i * count + j] >= 0.0f) {
+					const TileCoord& other = clusterNodes[first + j];
+					edgeList.push_back({ nodeOfTile[other.row * numCols + other.col], costs[i * count + j] });
+				}
+			}
+		}
+	}
+	for (const auto& interEdge : interEdges) {
+		nodeEdges[interEdge.first].push_back({ interEdge.second, 1.0f });
+		nodeEdges[interEdge.second].push_back({ interEdge.first, 1.0f });
+	}
+
+	edgeOffsets.assign(numNodes + 1, 0);
+	edges.clear();
+	for (int n = 0; n < numNodes; n++) {
+		edges.insert(edges.end(), nodeEdges[n].begin(), nodeEdges[n].end());
+		edgeOffsets[n + 1] = static_cast<int>(edges.size());
+	}
+
+	numMapCols = numCols;
+	builtFor = &tileMap;
+	builtVersion = tileMap.GetVersion();
+}
+
+bool HierarchicalPathfinder::IsBuiltFor(const TileMap& tileMap) const {
+	return builtFor == &tileMap && builtVersion == tileMap.GetVersion() && nodeOfTile.size() == static_cast<size_t>(tileMap.GetNumCols()) * tileMap.GetNumRows();
+}
+
+bool HierarchicalPathfinder::SearchAbstract(Scratch& scratch, TileCoord start, TileCoord goal, int startCluster, int goalCluster) const {
+	const int numNodes = static_cast<int>(nodes.size());
+	const int startNode = numNodes;
+	const int goalNode = numNodes + 1;
+	const size_t arenaSize = numNodes + 2;
+	if (scratch.g.size() < arenaSize) {
+		scratch.g.resize(arenaSize);
+		scratch.parent.resize(arenaSize);
+		scratch.openStamp.resize(arenaSize, 0);
+		scratch.closedStamp.resize(arenaSize, 0);
+	}
+	if (++scratch.generation == 0) {
+		std::fill(scratch.openStamp.begin(), scratch.openStamp.end(), 0);
+		std::fill(scratch.closedStamp.begin(), scratch.closedStamp.end(), 0);
+		scratch.generation = 1;
+	}
+	const uint32_t generation = scratch.generation;
+	auto& heap = scratch.heap;
+	heap.clear();
+
+	// Heap order: the entry with the lowest f is on top
+	auto compare = [](const Scratch::HeapEntry& a, const Scratch::HeapEntry& b) { return a.f > b.f; };
+	auto relax = [&](int from, int to, float cost) {
+		if (scratch.closedStamp[to] == generation) {
+			return;
+		}
+		const float nextG = scratch.g[from] + cost;
+		if (scratch.openStamp[to] == generation && scratch.g[to] <= nextG) {
+			return;
+		}
+		scratch.openStamp[to] = generation;
+		scratch.g[to] = nextG;
+		scratch.parent[to] = from;
+		const TileCoord tile = to == goalNode ? goal : nodes[to].tile;
+		heap.push_back({ nextG + TilePathfinder::Heuristic(tile, goal), to });
+		std::push_heap(heap.begin(), heap.end(), compare);
+	};
+
+	scratch.openStamp[startNode] = generation;
+	scratch.g[startNode] = 0.0f;
+	scratch.parent[startNode] = -1;
+	heap.push_back({ TilePathfinder::Heuristic(start, goal), startNode });
+
+	const int startFirst = clusterNodeOffsets[startCluster];
+	while (!heap.empty()) {
+		std::pop_heap(heap.begin(), heap.end(), compare);
+		const int node = heap.back().node;
+		heap.pop_back();
+		if (scratch.closedStamp[node] == generation) {
+			continue;
+		}
+		scratch.closedStamp[node] = generation;
+
+		if (node == goalNode) {
+			scratch.abstractPath.clear();
+			for (int n = goalNode; n != -1; n = scratch.parent[n]) {
+				scratch.abstractPath.push_back(n);
+			}
+			std::reverse(scratch.abstractPath.begin(), scratch.abstractPath.end());
+			return true;
+		}
+
+		if (node == startNode) {
+			for (size_t i = 0; i < scratch.startCosts.size(); i++) {
+				if (scratch.startCosts[i] >= 0.0f) {
+					const TileCoord& tile = clusterNodes[startFirst + i];
+					relax(node, nodeOfTile[tile.row * numMapCols + tile.col], scratch.startCosts[i]);
+				}
+			}
+			continue;
+		}
+
+		for (int e = edgeOffsets[node]; e < edgeOffsets[node + 1]; e++) {
+			relax(node, edges[e].to, edges[e].cost);
+		}
+		if (nodes[node].cluster == goalCluster) {
+			const float cost = scratch.goalCosts[nodes[node].indexInCluster];
+			if (cost >= 0.0f) {
+				relax(node, goalNode, cost);
+			}
+		}
+	}
+	return false;
+}
+
+bool HierarchicalPathfinder::FindPath(const TileMap& tileMap, TileCoord start, TileCoord goal, Scratch& scratch, std::vector<TileCoord>& path) const {
+	path.clear();
+	const int numCols = tileMap.GetNumCols();
+	const int numRows = tileMap.GetNumRows();
+	if (start.col < 0 || start.row < 0 || start.col >= numCols || start.row >= numRows ||
+		goal.col < 0 || goal.row < 0 || goal.col >= numCols || goal.row >= numRows || tileMap.IsSolid(goal.col, goal.row)) {
+		return false;
+	}
+
+	// Near the goal a plain search over the clusters around the start is cheap, and the hierarchy
+	// could only make the path worse; if the way round leaves those clusters, the hierarchy finds it
+	const int startCluster = GetCluster(start);
+	const int goalCluster = GetCluster(goal);
+	const int startClusterCol = startCluster % numClusterCols;
+	const int startClusterRow = startCluster / numClusterCols;
+	if (std::abs(startClusterCol - goalCluster % numClusterCols) <= 1 && std::abs(startClusterRow - goalCluster / numClusterCols) <= 1) {
+		const TileBounds neighbourhood = {
+			(startClusterCol - 1) * CLUSTER_SIZE, (startClusterRow - 1) * CLUSTER_SIZE,
+			(startClusterCol + 2) * CLUSTER_SIZE - 1, (startClusterRow + 2) * CLUSTER_SIZE - 1
+		};
+		if (scratch.tilePathfinder.FindPath(tileMap, start, goal, neighbourhood, path)) {
+			return true;
+		}
+	}
+
+	// Join the start and the goal to the transition tiles of their clusters
+	const int startFirst = clusterNodeOffsets[startCluster];
+	const int startCount = clusterNodeOffsets[startCluster + 1] - startFirst;
+	scratch.startCosts.resize(startCount);
+	scratch.tilePathfinder.FindCosts(tileMap, start, GetClusterBounds(tileMap, startCluster), clusterNodes.data() + startFirst, startCount, scratch.startCosts.data());
+
+	const int goalFirst = clusterNodeOffsets[goalCluster];
+	const int goalCount = clusterNodeOffsets[goalCluster + 1] - goalFirst;
+	scratch.goalCosts.resize(goalCount);
+	scratch.tilePathfinder.FindCosts(tileMap, goal, GetClusterBounds(tileMap, goalCluster), clusterNodes.data() + goalFirst, goalCount, scratch.goalCosts.data());
+
+	if (!SearchAbstract(scratch, start, goal, startCluster, goalCluster)) {
+		return false;
+	}
+
+	// Refine every abstract step into tiles
+	const int startNode = static_cast<int>(nodes.size());
+	const int goalNode = startNode + 1;
+	path.push_back(start);
+	for (size_t i = 0; i + 1 < scratch.abstractPath.size(); i++) {
+		const int from = scratch.abstractPath[i];
+		const int to = scratch.abstractPath[i + 1];
+		const TileCoord fromTile = from == startNode ? start : nodes[from].tile;
+		const TileCoord toTile = to == goalNode ? goal : nodes[to].tile;
+
+		// A step between two clusters crosses an entrance: the tiles are neighbours
+		if (from != startNode && to != goalNode && nodes[from].cluster != nodes[to].cluster) {
+			path.push_back(toTile);
+			continue;
+		}
+
+		const int cluster = from == startNode ? startCluster : (to == goalNode ? goalCluster : nodes[from].cluster);
+		if (!scratch.tilePathfinder.FindPath(tileMap, fromTile, toTile, GetClusterBounds(tileMap, cluster), scratch.segment)) {
+			path.clear();
+			return false;
+		}
+		path.insert(path.end(), scratch.segment.begin() + 1, scratch.segment.end());
+	}
+	return true;
+}
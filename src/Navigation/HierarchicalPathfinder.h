@@ -0,0 +1,111 @@
+#ifndef HIERARCHICALPATHFINDER_H
+#define HIERARCHICALPATHFINDER_H
+
+#include "TilePathfinder.h"
+#include "../TileMap/TileMap.h"
+#include "../Jobs/JobSystem.h"
+#include <cstdint>
+#include <vector>
+
+//*************************************************************************************
+// HIERARCHICAL PATHFINDER
+// HPA*: the map is cut into square clusters of tiles. Wherever two neighbouring clusters
+// share a run of open tiles along their border there is an entrance, marked by a pair of
+// transition tiles, one on each side. The transition tiles are the nodes of a small
+// abstract graph: the two tiles of a pair are joined by a step, and the tiles of one
+// cluster are joined by the cost of the best path between them inside the cluster.
+// A long path is first found on the abstract graph and then refined into tiles, one
+// cluster at a time. Units close to their goal skip the hierarchy and use plain A*
+// confined to the 3x3 clusters around them, falling back to the hierarchy only if that
+// finds nothing, so no tile search ever covers more than 3x3 clusters.
+// The graph is built for one version of the map and is read only afterwards, so any
+// number of threads can search it, each with its own Scratch. Rebuilding it after the
+// map changes only searches the clusters whose tiles or transition tiles changed; the
+// other clusters keep the inner path costs of the last build.
+//*************************************************************************************
+
+class HierarchicalPathfinder {
+public:
+	static const int CLUSTER_SIZE = 16;
+
+	// Per thread search state
+	class Scratch {
+	private:
+		friend class HierarchicalPathfinder;
+
+		struct HeapEntry {
+			float f;
+			int node;
+		};
+
+		TilePathfinder tilePathfinder;
+
+		// Abstract search arenas, [index = abstract node]; the start and goal are the last two nodes
+		std::vector<float> g;
+		std::vector<int> parent;
+		std::vector<uint32_t> openStamp;
+		std::vector<uint32_t> closedStamp;
+		uint32_t generation = 0;
+		std::vector<HeapEntry> heap;
+
+		// Costs from the start to the nodes of its cluster and from the nodes of the goal's cluster to the goal
+		std::vector<float> startCosts;
+		std::vector<float> goalCosts;
+
+		std::vector<int> abstractPath;
+		std::vector<TileCoord> segment;
+	};
+
+private:
+	struct Edge {
+		int to;
+		float cost;
+	};
+
+	struct Node {
+		TileCoord tile;
+		int cluster;
+		int indexInCluster;
+	};
+
+	const TileMap* builtFor = nullptr;
+	unsigned int builtVersion = 0;
+	int numMapCols = 0;
+	int numClusterCols = 0;
+	int numClusterRows = 0;
+
+	std::vector<Node> nodes;
+	std::vector<int> nodeOfTile;			// [index = row * numCols + col] abstract node of a transition tile, or -1
+	std::vector<int> edgeOffsets;			// edges of node n are edges[edgeOffsets[n] .. edgeOffsets[n + 1])
+	std::vector<Edge> edges;
+	std::vector<int> clusterNodeOffsets;	// nodes of cluster c are clusterNodes[clusterNodeOffsets[c] .. clusterNodeOffsets[c + 1])
+	std::vector<TileCoord> clusterNodes;
+
+	// Kept for the next build: the solid tiles this graph was built from, and per cluster the
+	// costs between its nodes, [i * count + j] from node i to node j, -1 where there is no path
+	std::vector<bool> builtSolid;			// [index = row * numCols + col]
+	std::vector<std::vector<float>> clusterCosts;
+
+	int GetCluster(TileCoord tile) const;
+	TileBounds GetClusterBounds(const TileMap& tileMap, int cluster) const;
+	void FindChangedClusters(const TileMap& tileMap, std::vector<bool>& isClusterChanged);
+	int AddTransitionNode(const TileMap& tileMap, TileCoord tile);
+	void AddEntrances(const TileMap& tileMap, std::vector<std::pair<int, int>>& interEdges);
+
+	// A* over the abstract graph from the start to the goal node; fills scratch.abstractPath
+	bool SearchAbstract(Scratch& scratch, TileCoord start, TileCoord goal, int startCluster, int goalCluster) const;
+
+public:
+	HierarchicalPathfinder() = default;
+
+	// Rebuilds the abstract graph; the changed clusters' inner paths are found in parallel
+	void Build(const TileMap& tileMap, JobSystem& jobSystem);
+	bool IsBuiltFor(const TileMap& tileMap) const;
+
+	int GetNumNodes() const { return static_cast<int>(nodes.size()); }
+
+	// Writes the tiles from start to goal to path; returns false if there is no path
+	bool FindPath(const TileMap& tileMap, TileCoord start, TileCoord goal, Scratch& scratch, std::vector<TileCoord>& path) const;
+};
+
+#endif
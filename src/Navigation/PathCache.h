@@ -0,0 +1,121 @@
+#ifndef PATHCACHE_H
+#define PATHCACHE_H
+
+#include "TilePathfinder.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+//*************************************************************************************
+// PATH CACHE
+// The most recently used paths, keyed by start and goal tile. Units of one group asking
+// for the same trip share one search. When the cache is full the least recently used
+// path makes room, and its slot and tile list are reused. Failed searches are cached
+// too, so an unreachable goal is not searched again.
+// The cache does not know about the map: clear it whenever the map changes.
+//*************************************************************************************
+
+class PathCache {
+private:
+	struct Entry {
+		uint64_t key;
+		bool isFound;
+		std::vector<TileCoord> tiles;
+		int previous;		// towards the most recently used entry
+		int next;			// towards the least recently used entry
+	};
+
+	std::vector<Entry> entries;
+	std::unordered_map<uint64_t, int> slotOfKey;
+	int mostRecent = -1;
+	int leastRecent = -1;
+	size_t capacity;
+
+	void Unlink(int slot) {
+		Entry& entry = entries[slot];
+		if (entry.previous >= 0) {
+			entries[entry.previous].next = entry.next;
+		} else {
+			mostRecent = entry.next;
+		}
+		if (entry.next >= 0) {
+			entries[entry.next].previous = entry.previous;
+		} else {
+			leastRecent = entry.previous;
+		}
+	}
+
+	void LinkFirst(int slot) {
+		Entry& entry = entries[slot];
+		entry.previous = -1;
+		entry.next = mostRecent;
+		if (mostRecent >= 0) {
+			entries[mostRecent].previous = slot;
+		} else {
+			leastRecent = slot;
+		}
+		mostRecent = slot;
+	}
+
+public:
+	PathCache(size_t capacity = 256) {
+		this->capacity = capacity > 0 ? capacity : 1;
+		entries.reserve(this->capacity);
+		slotOfKey.reserve(this->capacity);
+	}
+
+	static uint64_t MakeKey(const TileMap& tileMap, TileCoord start, TileCoord goal) {
+		const uint64_t numCols = static_cast<uint64_t>(tileMap.GetNumCols());
+		return ((start.row * numCols + start.col) << 32) | (goal.row * numCols + goal.col);
+	}
+
+	// Copies a cached path to tiles and marks it as recently used; returns false on a miss
+	bool Find(uint64_t key, bool& isFound, std::vector<TileCoord>& tiles) {
+		auto it = slotOfKey.find(key);
+		if (it == slotOfKey.end()) {
+			return false;
+		}
+		const int slot = it->second;
+		Unlink(slot);
+		LinkFirst(slot);
+		isFound = entries[slot].isFound;
+		tiles.assign(entries[slot].tiles.begin(), entries[slot].tiles.end());
+		return true;
+	}
+
+	void Insert(uint64_t key, bool isFound, const std::vector<TileCoord>& tiles) {
+		int slot;
+		auto it = slotOfKey.find(key);
+		if (it != slotOfKey.end()) {
+			slot = it->second;
+			Unlink(slot);
+		} else if (entries.size() < capacity) {
+			slot = static_cast<int>(entries.size());
+			entries.push_back(Entry());
+			slotOfKey[key] = slot;
+		} else {
+			slot = leastRecent;
+			Unlink(slot);
+			slotOfKey.erase(entries[slot].key);
+			slotOfKey[key] = slot;
+		}
+		Entry& entry = entries[slot];
+		entry.key = key;
+		entry.isFound = isFound;
+		entry.tiles.assign(tiles.begin(), tiles.end());
+		LinkFirst(slot);
+	}
+
+	void Clear() {
+		entries.clear();
+		slotOfKey.clear();
+		mostRecent = -1;
+		leastRecent = -1;
+	}
+
+	size_t GetSize() const {
+		return entries.size();
+	}
+};
+
+#endif
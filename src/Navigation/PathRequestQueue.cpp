@@ -0,0 +1,88 @@
+#include "PathRequestQueue.h"
+#include <chrono>
+#include <limits>
+
+// Requests each thread gets per batch: enough to keep the threads busy, few enough to stop close to the budget
+static const size_t REQUESTS_PER_THREAD = 4;
+
+PathRequestQueue::PathRequestQueue(size_t cacheCapacity) : cache(cacheCapacity) {
+}
+
+int PathRequestQueue::Request(int entityId, TileCoord start, TileCoord goal) {
+	const int requestId = nextRequestId++;
+	pending.push_back({ requestId, entityId, start, goal });
+	return requestId;
+}
+
+void PathRequestQueue::Update(const TileMap& tileMap, JobSystem& jobSystem, double budgetSeconds) {
+	Solve(tileMap, jobSystem, budgetSeconds, std::numeric_limits<size_t>::max());
+}
+
+void PathRequestQueue::UpdateByCount(const TileMap& tileMap, JobSystem& jobSystem, size_t maxRequests) {
+	Solve(tileMap, jobSystem, std::numeric_limits<double>::infinity(), maxRequests);
+}
+
+void PathRequestQueue::Solve(const TileMap& tileMap, JobSystem& jobSystem, double budgetSeconds, size_t maxRequests) {
+	numResults = 0;
+	if (pending.empty()) {
+		return;
+	}
+
+	const auto startTime = std::chrono::steady_clock::now();
+	if (!pathfinder.IsBuiltFor(tileMap)) {
+		pathfinder.Build(tileMap, jobSystem);
+		cache.Clear();
+	}
+
+	const size_t numThreads = static_cast<size_t>(jobSystem.GetNumThreads());
+	if (scratches.size() < numThreads) {
+		scratches.resize(numThreads);
+	}
+
+	do {
+		batch.clear();
+		while (!pending.empty() && batch.size() < numThreads * REQUESTS_PER_THREAD && numResults + batch.size() < maxRequests) {
+			batch.push_back(pending.front());
+			pending.pop_front();
+		}
+		if (results.size() < numResults + batch.size()) {
+			results.resize(numResults + batch.size());
+		}
+
+		// Cached answers first; the rest are searched in parallel
+		batchToSolve.clear();
+		for (size_t i = 0; i < batch.size(); i++) {
+			PathResult& result = results[numResults + i];
+			result.requestId = batch[i].requestId;
+			result.entityId = batch[i].entityId;
+			const uint64_t key = PathCache::MakeKey(tileMap, batch[i].start, batch[i].goal);
+			if (!cache.Find(key, result.isFound, result.tiles)) {
+				batchToSolve.push_back(i);
+			}
+		}
+
+		// One job per thread, so the job's index picks a scratch no other job is using
+		const size_t jobSize = (batchToSolve.size() + numThreads - 1) / numThreads;
+		jobSystem.ParallelFor(batchToSolve.size(), jobSize, [&](size_t begin, size_t end) {
+			HierarchicalPathfinder::Scratch& scratch = scratches[begin / jobSize];
+			for (size_t i = begin; i < end; i++) {
+				const PathRequest& request = batch[batchToSolve[i]];
+				PathResult& result = results[numResults + batchToSolve[i]];
+				result.isFound = pathfinder.FindPath(tileMap, request.start, request.goal, scratch, result.tiles);
+			}
+		});
+
+		for (size_t i : batchToSolve) {
+			const PathResult& result = results[numResults + i];
+			cache.Insert(PathCache::MakeKey(tileMap, batch[i].start, batch[i].goal), result.isFound, result.tiles);
+		}
+		numResults += batch.size();
+	} while (!pending.empty() && numResults < maxRequests && std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() < budgetSeconds);
+}
+
+void PathRequestQueue::Clear() {
+	pending.clear();
+	numResults = 0;
+	cache.Clear();
+	pathfinder = HierarchicalPathfinder();
+}
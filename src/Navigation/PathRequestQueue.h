@@ -0,0 +1,79 @@
+#ifndef PATHREQUESTQUEUE_H
+#define PATHREQUESTQUEUE_H
+
+#include "TilePathfinder.h"
+#include "HierarchicalPathfinder.h"
+#include "PathCache.h"
+#include "../TileMap/TileMap.h"
+#include "../Jobs/JobSystem.h"
+#include <deque>
+#include <vector>
+
+struct PathRequest {
+	int requestId;
+	int entityId;
+	TileCoord start;
+	TileCoord goal;
+};
+
+struct PathResult {
+	int requestId;
+	int entityId;
+	bool isFound;
+	std::vector<TileCoord> tiles;	// start to goal, both included
+};
+
+//*************************************************************************************
+// PATH REQUEST QUEUE
+// Units ask for paths here instead of searching themselves. Each Update solves queued
+// requests in batches spread over the job system's threads, one search scratch per
+// thread, and stops starting new batches once its time budget is spent; the rest wait
+// for the next step. So a whole army repathing at once costs a few steps of latency
+// rather than one very long frame.
+// A deterministic simulation bounds each Update by a count of requests instead, so the
+// same requests are answered in the same step on any machine.
+// Answers come from the path cache when possible. Whenever the tile map changes the
+// cache is cleared and the hierarchical graph rebuilt, searching again only the
+// clusters around the changed tiles.
+//*************************************************************************************
+
+class PathRequestQueue {
+private:
+	HierarchicalPathfinder pathfinder;
+	PathCache cache;
+	std::vector<HierarchicalPathfinder::Scratch> scratches;
+
+	std::deque<PathRequest> pending;
+	std::vector<PathRequest> batch;
+	std::vector<size_t> batchToSolve;
+	int nextRequestId = 1;
+
+	// Results of the last Update; the pool only grows, so the tile lists keep their memory
+	std::vector<PathResult> results;
+	size_t numResults = 0;
+
+	void Solve(const TileMap& tileMap, JobSystem& jobSystem, double budgetSeconds, size_t maxRequests);
+
+public:
+	PathRequestQueue(size_t cacheCapacity = 256);
+
+	// Queues a search and returns its id, which the result will carry
+	int Request(int entityId, TileCoord start, TileCoord goal);
+
+	// Solves queued requests until budgetSeconds have passed; at least one batch is always solved
+	void Update(const TileMap& tileMap, JobSystem& jobSystem, double budgetSeconds);
+
+	// Solves the oldest maxRequests queued requests, however long they take and however many threads there are
+	void UpdateByCount(const TileMap& tileMap, JobSystem& jobSystem, size_t maxRequests);
+
+	// Results of the last Update, valid until the next
+	size_t GetNumResults() const { return numResults; }
+	const PathResult& GetResult(size_t index) const { return results[index]; }
+
+	size_t GetNumPending() const { return pending.size(); }
+
+	// Drops queued requests, results, cached paths and the graph, e.g. when the level changes
+	void Clear();
+};
+
+#endif
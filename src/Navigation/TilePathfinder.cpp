@@ -0,0 +1,162 @@
+#include "TilePathfinder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+static const float DIAGONAL_COST = 1.41421356f;
+
+float TilePathfinder::Heuristic(TileCoord a, TileCoord b) {
+	const int dx = std::abs(a.col - b.col);
+	const int dy = std::abs(a.row - b.row);
+	return (dx + dy) + (DIAGONAL_COST - 2.0f) * std::min(dx, dy);
+}
+
+bool TilePathfinder::BeginSearch(const TileMap& tileMap, const TileBounds& searchBounds) {
+	bounds.col0 = std::max(searchBounds.col0, 0);
+	bounds.row0 = std::max(searchBounds.row0, 0);
+	bounds.col1 = std::min(searchBounds.col1, tileMap.GetNumCols() - 1);
+	bounds.row1 = std::min(searchBounds.row1, tileMap.GetNumRows() - 1);
+	if (bounds.col0 > bounds.col1 || bounds.row0 > bounds.row1) {
+		return false;
+	}
+	width = bounds.col1 - bounds.col0 + 1;
+
+	// The arenas only ever grow; new entries carry stamp 0, which no search uses
+	const size_t numNodes = static_cast<size_t>(width) * (bounds.row1 - bounds.row0 + 1);
+	if (g.size() < numNodes) {
+		g.resize(numNodes);
+		parent.resize(numNodes);
+		openStamp.resize(numNodes, 0);
+		closedStamp.resize(numNodes, 0);
+	}
+
+	if (++generation == 0) {
+		std::fill(openStamp.begin(), openStamp.end(), 0);
+		std::fill(closedStamp.begin(), closedStamp.end(), 0);
+		generation = 1;
+	}
+	heap.clear();
+	return true;
+}
+
+void TilePathfinder::Push(int node, float f) {
+	heap.push_back({ f, node });
+	std::push_heap(heap.begin(), heap.end(), IsLowerPriority);
+}
+
+int TilePathfinder::Pop() {
+	std::pop_heap(heap.begin(), heap.end(), IsLowerPriority);
+	const int node = heap.back().node;
+	heap.pop_back();
+	return node;
+}
+
+bool TilePathfinder::IsOpen(const TileMap& tileMap, int col, int row) const {
+	return col >= bounds.col0 && col <= bounds.col1 && row >= bounds.row0 && row <= bounds.row1 && !tileMap.IsSolid(col, row);
+}
+
+void TilePathfinder::ExpandNode(const TileMap& tileMap, int node, bool hasGoal, TileCoord heuristicGoal) {
+	static const int STEP_COLS[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+	static const int STEP_ROWS[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+	const int col = bounds.col0 + node % width;
+	const int row = bounds.row0 + node / width;
+	for (int i = 0; i < 8; i++) {
+		const int nextCol = col + STEP_COLS[i];
+		const int nextRow = row + STEP_ROWS[i];
+		if (!IsOpen(tileMap, nextCol, nextRow)) {
+			continue;
+		}
+		const bool isDiagonal = i >= 4;
+		if (isDiagonal && (!IsOpen(tileMap, nextCol, row) || !IsOpen(tileMap, col, nextRow))) {
+			continue;
+		}
+
+		const int next = ToNode(nextCol, nextRow);
+		if (closedStamp[next] == generation) {
+			continue;
+		}
+		const float nextG = g[node] + (isDiagonal ? DIAGONAL_COST : 1.0f);
+		if (openStamp[next] == generation && g[next] <= nextG) {
+			continue;
+		}
+		openStamp[next] = generation;
+		g[next] = nextG;
+		parent[next] = node;
+		Push(next, hasGoal ? nextG + Heuristic({ nextCol, nextRow }, heuristicGoal) : nextG);
+	}
+}
+
+bool TilePathfinder::FindPath(const TileMap& tileMap, TileCoord start, TileCoord goal, const TileBounds& searchBounds, std::vector<TileCoord>& path) {
+	path.clear();
+	if (!BeginSearch(tileMap, searchBounds)) {
+		return false;
+	}
+	const bool isStartInside = start.col >= bounds.col0 && start.col <= bounds.col1 && start.row >= bounds.row0 && start.row <= bounds.row1;
+	if (!isStartInside || !IsOpen(tileMap, goal.col, goal.row)) {
+		return false;
+	}
+
+	const int startNode = ToNode(start.col, start.row);
+	const int goalNode = ToNode(goal.col, goal.row);
+	openStamp[startNode] = generation;
+	g[startNode] = 0.0f;
+	parent[startNode] = -1;
+	Push(startNode, Heuristic(start, goal));
+
+	while (!heap.empty()) {
+		const int node = Pop();
+		if (closedStamp[node] == generation) {
+			continue;	// stale entry of a node reached again more cheaply
+		}
+		closedStamp[node] = generation;
+
+		if (node == goalNode) {
+			for (int n = goalNode; n != -1; n = parent[n]) {
+				path.push_back({ bounds.col0 + n % width, bounds.row0 + n / width });
+			}
+			std::reverse(path.begin(), path.end());
+			return true;
+		}
+		ExpandNode(tileMap, node, true, goal);
+	}
+	return false;
+}
+
+void TilePathfinder::FindCosts(const TileMap& tileMap, TileCoord start, const TileBounds& searchBounds, const TileCoord* targets, int numTargets, float* costs) {
+	std::fill(costs, costs + numTargets, -1.0f);
+	if (!BeginSearch(tileMap, searchBounds)) {
+		return;
+	}
+	if (start.col < bounds.col0 || start.col > bounds.col1 || start.row < bounds.row0 || start.row > bounds.row1) {
+		return;
+	}
+
+	const int startNode = ToNode(start.col, start.row);
+	openStamp[startNode] = generation;
+	g[startNode] = 0.0f;
+	parent[startNode] = -1;
+	Push(startNode, 0.0f);
+
+	// Without a goal the search has to run until the reachable part of the bounds is done,
+	// which for the small areas this is used on is cheaper than one search per target
+	while (!heap.empty()) {
+		const int node = Pop();
+		if (closedStamp[node] == generation) {
+			continue;
+		}
+		closedStamp[node] = generation;
+		ExpandNode(tileMap, node, false, start);
+	}
+
+	for (int i = 0; i < numTargets; i++) {
+		const TileCoord& target = targets[i];
+		if (target.col < bounds.col0 || target.col > bounds.col1 || target.row < bounds.row0 || target.row > bounds.row1) {
+			continue;
+		}
+		const int node = ToNode(target.col, target.row);
+		if (closedStamp[node] == generation) {
+			costs[i] = g[node];
+		}
+	}
+}
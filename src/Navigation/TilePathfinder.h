@@ -0,0 +1,83 @@
+#ifndef TILEPATHFINDER_H
+#define TILEPATHFINDER_H
+
+#include "../TileMap/TileMap.h"
+#include <cstdint>
+#include <vector>
+
+struct TileCoord {
+	int col;
+	int row;
+};
+
+inline bool operator==(const TileCoord& a, const TileCoord& b) {
+	return a.col == b.col && a.row == b.row;
+}
+
+// Inclusive rectangle of tiles a search may not leave
+struct TileBounds {
+	int col0, row0;
+	int col1, row1;
+};
+
+//*************************************************************************************
+// TILE PATHFINDER
+// A* over the open tiles of a TileMap, 8-connected: diagonal steps cost sqrt(2) and may
+// not cut the corner of a solid tile. The open list is a binary heap that may hold stale
+// entries, which are skipped when popped.
+// The per tile scores live in arenas that are kept between searches; a generation stamp
+// marks which entries belong to the current search, so nothing is cleared per search.
+// A search can be confined to a rectangle of tiles, which the hierarchical pathfinder
+// uses to search inside one cluster.
+// One pathfinder is not thread safe: give each thread its own.
+//*************************************************************************************
+
+class TilePathfinder {
+private:
+	struct HeapEntry {
+		float f;
+		int node;
+	};
+
+	// Heap order: the entry with the lowest f is on top
+	static bool IsLowerPriority(const HeapEntry& a, const HeapEntry& b) { return a.f > b.f; }
+
+	// [index = node, the tile's position inside the search bounds]
+	std::vector<float> g;
+	std::vector<int> parent;
+	std::vector<uint32_t> openStamp;
+	std::vector<uint32_t> closedStamp;
+	uint32_t generation = 0;
+
+	std::vector<HeapEntry> heap;
+
+	TileBounds bounds = { 0, 0, -1, -1 };
+	int width = 0;
+
+	// Starts a search over bounds (clipped to the map); returns false if nothing of the map is left
+	bool BeginSearch(const TileMap& tileMap, const TileBounds& searchBounds);
+	void Push(int node, float f);
+	int Pop();
+
+	int ToNode(int col, int row) const { return (row - bounds.row0) * width + (col - bounds.col0); }
+	bool IsOpen(const TileMap& tileMap, int col, int row) const;
+
+	// Relaxes the neighbours of node; heuristicGoal is ignored for a Dijkstra search (hasGoal false)
+	void ExpandNode(const TileMap& tileMap, int node, bool hasGoal, TileCoord heuristicGoal);
+
+public:
+	TilePathfinder() = default;
+
+	// Octile distance: the exact cost of the best path on an empty grid
+	static float Heuristic(TileCoord a, TileCoord b);
+
+	// Writes the tiles from start to goal (both included) to path; returns false if no path exists
+	// The start tile itself may be solid, so a unit pressed against a wall can still leave it
+	bool FindPath(const TileMap& tileMap, TileCoord start, TileCoord goal, const TileBounds& searchBounds, std::vector<TileCoord>& path);
+
+	// Cost of the best path from start to each of the targets, or -1 where there is none
+	// One Dijkstra search answers all of them
+	void FindCosts(const TileMap& tileMap, TileCoord start, const TileBounds& searchBounds, const TileCoord* targets, int numTargets, float* costs);
+};
+
+#endif
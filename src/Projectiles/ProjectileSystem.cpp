@@ -0,0 +1,259 @@
+#include "ProjectileSystem.h"
+#include "../ECS/ECS.h"
+#include "../EventBus/EventBus.h"
+#include "../Events/ProjectileHitEvent.h"
+#include "../AssetManager/AssetStore.h"
+#include "../TileMap/TileMap.h"
+#include "../TileMap/TileRaycast.h"
+#include "../Systems/CollisionSystem.h"
+#include "../Systems/MovementKernels.h"
+#include <algorithm>
+#include <cmath>
+
+// hitTimes of a bullet that hit nothing this step
+static const float NO_HIT = 2.0f;
+
+ProjectileSystem::ProjectileSystem(size_t capacity, int size, const std::string& assetId, float cellSize) {
+	this->capacity = capacity;
+	this->size = size;
+	this->assetId = assetId;
+	this->cellSize = cellSize;
+	this->inverseCellSize = 1.0f / cellSize;
+
+	// Everything is allocated here, once
+	positionX.resize(capacity);
+	positionY.resize(capacity);
+	previousX.resize(capacity);
+	previousY.resize(capacity);
+	velocityX.resize(capacity);
+	velocityY.resize(capacity);
+	lifetimes.resize(capacity);
+	masks.resize(capacity);
+	ownerIds.resize(capacity);
+	hitTimes.resize(capacity);
+	hitEntityIds.resize(capacity);
+	bulletCellX.resize(capacity);
+	bulletCellY.resize(capacity);
+	cellBullets.resize(capacity);
+	vertices.resize(capacity * 4);
+
+	// Two triangles per bullet; the pattern never changes
+	indices.resize(capacity * 6);
+	for (size_t i = 0; i < capacity; i++) {
+		const int vertex = static_cast<int>(i * 4);
+		int* quad = &indices[i * 6];
+		quad[0] = vertex;
+		quad[1] = vertex + 1;
+		quad[2] = vertex + 2;
+		quad[3] = vertex;
+		quad[4] = vertex + 2;
+		quad[5] = vertex + 3;
+	}
+
+	unsigned int bucketCount = 64;
+	while (bucketCount < capacity) {
+		bucketCount *= 2;
+	}
+	bucketMask = bucketCount - 1;
+	bucketStart.resize(bucketCount + 1);
+	bucketFill.resize(bucketCount);
+}
+
+int ProjectileSystem::ToCell(float coordinate) const {
+	return static_cast<int>(std::floor(coordinate * inverseCellSize));
+}
+
+unsigned int ProjectileSystem::HashCell(int cellX, int cellY) const {
+	return ((static_cast<unsigned int>(cellX) * 73856093u) ^ (static_cast<unsigned int>(cellY) * 19349663u)) & bucketMask;
+}
+
+bool ProjectileSystem::Spawn(glm::vec2 position, glm::vec2 velocity, float lifetime, uint32_t mask, int ownerId) {
+	if (count == capacity) {
+		return false;
+	}
+
+	const size_t index = count++;
+	positionX[index] = position.x;
+	positionY[index] = position.y;
+	previousX[index] = position.x;
+	previousY[index] = position.y;
+	velocityX[index] = velocity.x;
+	velocityY[index] = velocity.y;
+	lifetimes[index] = lifetime;
+	masks[index] = mask;
+	ownerIds[index] = ownerId;
+	maxSpeed = std::max(maxSpeed, glm::length(velocity));
+	return true;
+}
+
+// Move the last bullet into the hole
+void ProjectileSystem::Despawn(size_t index) {
+	const size_t last = --count;
+	positionX[index] = positionX[last];
+	positionY[index] = positionY[last];
+	previousX[index] = previousX[last];
+	previousY[index] = previousY[last];
+	velocityX[index] = velocityX[last];
+	velocityY[index] = velocityY[last];
+	lifetimes[index] = lifetimes[last];
+	masks[index] = masks[last];
+	ownerIds[index] = ownerIds[last];
+}
+
+void ProjectileSystem::Clear() {
+	count = 0;
+	maxSpeed = 0.0f;
+}
+
+void ProjectileSystem::CollideWithTiles(const TileMap& tileMap) {
+	if (tileMap.GetNumCols() == 0) {
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (lifetimes[i] <= 0.0f || (masks[i] & COLLISION_LAYER_SCENERY) == 0) {
+			continue;
+		}
+
+		// Most bullets stay inside one tile per step and need a single bit lookup
+		const int col = tileMap.ToTile(positionX[i]);
+		const int row = tileMap.ToTile(positionY[i]);
+		if (col == tileMap.ToTile(previousX[i]) && row == tileMap.ToTile(previousY[i])) {
+			if (tileMap.IsSolid(col, row)) {
+				hitTimes[i] = 0.0f;
+				hitEntityIds[i] = -1;
+			}
+			continue;
+		}
+
+		// Otherwise walk the tiles between the two positions
+		const glm::vec2 start(previousX[i], previousY[i]);
+		const glm::vec2 path = glm::vec2(positionX[i], positionY[i]) - start;
+		const float length = glm::length(path);
+		const TileRayHit hit = RaycastTiles(tileMap, { start, path, length });
+		if (hit.isHit) {
+			hitTimes[i] = hit.distance / length;
+			hitEntityIds[i] = -1;
+		}
+	}
+}
+
+void ProjectileSystem::CollideWithColliders(Registry& registry, float deltaTime) {
+	// Bin the live bullets by the cell of their position (counting sort, as in the spatial hash grid)
+	const unsigned int bucketCount = bucketMask + 1;
+	std::fill(bucketStart.begin(), bucketStart.end(), 0);
+	uint32_t maskUnion = 0;
+	for (size_t i = 0; i < count; i++) {
+		if (lifetimes[i] <= 0.0f) {
+			continue;
+		}
+		bulletCellX[i] = ToCell(positionX[i]);
+		bulletCellY[i] = ToCell(positionY[i]);
+		bucketStart[HashCell(bulletCellX[i], bulletCellY[i]) + 1]++;
+		maskUnion |= masks[i];
+	}
+	for (unsigned int bucket = 0; bucket < bucketCount; bucket++) {
+		bucketStart[bucket + 1] += bucketStart[bucket];
+	}
+	std::copy(bucketStart.begin(), bucketStart.end() - 1, bucketFill.begin());
+	for (size_t i = 0; i < count; i++) {
+		if (lifetimes[i] > 0.0f) {
+			cellBullets[bucketFill[HashCell(bulletCellX[i], bulletCellY[i])]++] = static_cast<int>(i);
+		}
+	}
+
+	// A bullet that hit a box this step ended the step at most this far from it
+	const float reach = maxSpeed * deltaTime + size;
+	const glm::vec2 halfSize(size * 0.5f);
+
+	auto& transforms = registry.GetComponentPool<TransformComponent>();
+	auto& colliders = registry.GetComponentPool<BoxColliderComponent>();
+	for (auto entity : registry.GetSystem<CollisionSystem>().GetSystemEntities()) {
+		const int entityId = entity.GetId();
+		const auto& collider = colliders[entityId];
+		if ((collider.layer & maskUnion) == 0) {
+			continue;
+		}
+		const auto& transform = transforms[entityId];
+		AABB box;
+		box.min = transform.position + collider.offset;
+		box.max = box.min + glm::vec2(collider.width * transform.scale.x, collider.height * transform.scale.y);
+
+		const int x0 = ToCell(box.min.x - reach), x1 = ToCell(box.max.x + reach);
+		const int y0 = ToCell(box.min.y - reach), y1 = ToCell(box.max.y + reach);
+		for (int y = y0; y <= y1; y++) {
+			for (int x = x0; x <= x1; x++) {
+				const unsigned int bucket = HashCell(x, y);
+				for (int k = bucketStart[bucket]; k < bucketStart[bucket + 1]; k++) {
+					const int i = cellBullets[k];
+					if (bulletCellX[i] != x || bulletCellY[i] != y || lifetimes[i] <= 0.0f || (masks[i] & collider.layer) == 0) {
+						continue;
+					}
+
+					// Test the bullet's whole path this step against the box, keeping the earliest hit
+					const glm::vec2 start(previousX[i], previousY[i]);
+					const glm::vec2 path = glm::vec2(positionX[i], positionY[i]) - start;
+					float timeOfImpact;
+					if (SweptOverlaps({ start - halfSize, start + halfSize }, path, box, glm::vec2(0.0f), timeOfImpact) && timeOfImpact < hitTimes[i]) {
+						hitTimes[i] = timeOfImpact;
+						hitEntityIds[i] = entityId;
+					}
+				}
+			}
+		}
+	}
+}
+
+void ProjectileSystem::Update(Registry& registry, EventBus& eventBus, const TileMap& tileMap, double deltaTime) {
+	if (count == 0) {
+		maxSpeed = 0.0f;
+		return;
+	}
+	const float dt = static_cast<float>(deltaTime);
+
+	// Move and age every bullet, several at a time
+	std::copy(positionX.begin(), positionX.begin() + count, previousX.begin());
+	std::copy(positionY.begin(), positionY.begin() + count, previousY.begin());
+	IntegratePositions(positionX.data(), positionY.data(), velocityX.data(), velocityY.data(), count, dt);
+	for (size_t i = 0; i < count; i++) {
+		lifetimes[i] -= dt;
+	}
+	std::fill(hitTimes.begin(), hitTimes.begin() + count, NO_HIT);
+
+	CollideWithTiles(tileMap);
+	CollideWithColliders(registry, dt);
+
+	// Remove spent and stopped bullets from the back, so every bullet moved into a hole has already been checked
+	for (size_t i = count; i-- > 0;) {
+		if (hitTimes[i] <= 1.0f && hitEntityIds[i] >= 0) {
+			const glm::vec2 start(previousX[i], previousY[i]);
+			const glm::vec2 path = glm::vec2(positionX[i], positionY[i]) - start;
+			Entity target(hitEntityIds[i]);
+			target.registry = &registry;
+			eventBus.EmitEvent<ProjectileHitEvent>(target, ownerIds[i], start + path * hitTimes[i]);
+		}
+		if (hitTimes[i] <= 1.0f || lifetimes[i] <= 0.0f) {
+			Despawn(i);
+		}
+	}
+}
+
+void ProjectileSystem::Render(SDL_Renderer* renderer, AssetStore& assetStore, double interpolation) {
+	if (count == 0) {
+		return;
+	}
+
+	const float blend = static_cast<float>(interpolation);
+	const float halfSize = size * 0.5f;
+	const SDL_Color white = { 255, 255, 255, 255 };
+	for (size_t i = 0; i < count; i++) {
+		const float x = previousX[i] + (positionX[i] - previousX[i]) * blend;
+		const float y = previousY[i] + (positionY[i] - previousY[i]) * blend;
+		SDL_Vertex* quad = &vertices[i * 4];
+		quad[0] = { { x - halfSize, y - halfSize }, white, { 0.0f, 0.0f } };
+		quad[1] = { { x + halfSize, y - halfSize }, white, { 1.0f, 0.0f } };
+		quad[2] = { { x + halfSize, y + halfSize }, white, { 1.0f, 1.0f } };
+		quad[3] = { { x - halfSize, y + halfSize }, white, { 0.0f, 1.0f } };
+	}
+	SDL_RenderGeometry(renderer, assetStore.GetTexture(assetId), vertices.data(), static_cast<int>(count * 4), indices.data(), static_cast<int>(count * 6));
+}
@@ -0,0 +1,89 @@
+#ifndef PROJECTILESYSTEM_H
+#define PROJECTILESYSTEM_H
+
+#include <SDL.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Registry;
+class EventBus;
+class TileMap;
+class AssetStore;
+
+//*************************************************************************************
+// PROJECTILE SYSTEM
+// Bullets live outside the ECS in a fixed-capacity structure-of-arrays pool: spawning
+// appends, despawning moves the last bullet into the hole, and all storage is allocated
+// once up front. Each step the bullets move with the SIMD movement kernel, age, and are
+// collided as segments from their previous position, so fast bullets cannot tunnel:
+// against solid tiles through the tile map, and against collider entities through a
+// grid of bullets that each collider searches.
+// A bullet stops at the first thing along its path, whether a solid tile or a collider:
+// both tests record a time of impact and the earliest wins, so a bullet that crosses an
+// enemy and then a wall in one step hits the enemy. It is removed, and a
+// ProjectileHitEvent is emitted when it stopped at an entity.
+// All bullets are drawn with one SDL_RenderGeometry call from vertex and index arrays
+// sized for the whole pool.
+//*************************************************************************************
+
+class ProjectileSystem {
+private:
+	size_t capacity;
+	size_t count = 0;
+
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> previousX;
+	std::vector<float> previousY;
+	std::vector<float> velocityX;
+	std::vector<float> velocityY;
+	std::vector<float> lifetimes;		// seconds left, zero or less once the bullet is spent
+	std::vector<uint32_t> masks;		// collision layers the bullet hits
+	std::vector<int> ownerIds;
+
+	// This step's earliest hit of each bullet, as a fraction of its path; above 1 for none
+	std::vector<float> hitTimes;
+	std::vector<int> hitEntityIds;		// -1 for a tile
+
+	float maxSpeed = 0.0f;				// fastest bullet spawned, bounds how far a bullet moved this step
+
+	// Grid of the bullets' positions, rebuilt every step with a counting sort
+	float cellSize;
+	float inverseCellSize;
+	unsigned int bucketMask;
+	std::vector<int> bucketStart;
+	std::vector<int> bucketFill;
+	std::vector<int> cellBullets;		// bullet indices sorted by bucket
+	std::vector<int> bulletCellX;
+	std::vector<int> bulletCellY;
+
+	int size;
+	std::string assetId;
+	std::vector<SDL_Vertex> vertices;	// four per bullet
+	std::vector<int> indices;			// six per bullet, written once
+
+	int ToCell(float coordinate) const;
+	unsigned int HashCell(int cellX, int cellY) const;
+	void Despawn(size_t index);
+	void CollideWithTiles(const TileMap& tileMap);
+	void CollideWithColliders(Registry& registry, float deltaTime);
+
+public:
+	// size: width and height of a bullet in pixels; assetId: texture used to draw it
+	ProjectileSystem(size_t capacity, int size = 4, const std::string& assetId = "bullet", float cellSize = 64.0f);
+
+	// Returns false when the pool is full
+	bool Spawn(glm::vec2 position, glm::vec2 velocity, float lifetime, uint32_t mask, int ownerId = -1);
+	void Clear();
+
+	size_t GetCount() const { return count; }
+	size_t GetCapacity() const { return capacity; }
+
+	void Update(Registry& registry, EventBus& eventBus, const TileMap& tileMap, double deltaTime);
+	void Render(SDL_Renderer* renderer, AssetStore& assetStore, double interpolation);
+};
+
+#endif
@@ -0,0 +1,46 @@
+#include "FrameProfile.h"
+#include <algorithm>
+#include <fstream>
+
+void FrameProfile::AddFrame(double frameTime, int numSteps) {
+	frameTimes.push_back(frameTime);
+	frameSteps.push_back(numSteps);
+}
+
+FrameProfileSummary FrameProfile::GetSummary() const {
+	FrameProfileSummary summary;
+	summary.frameCount = frameTimes.size();
+	if (frameTimes.empty()) {
+		return summary;
+	}
+
+	for (size_t i = 0; i < frameTimes.size(); i++) {
+		summary.totalTime += frameTimes[i];
+		summary.stepCount += frameSteps[i];
+	}
+	summary.averageFrameTime = summary.totalTime / summary.frameCount;
+	summary.averageStepTime = summary.stepCount > 0 ? summary.totalTime / summary.stepCount : 0.0;
+
+	std::vector<double> sorted = frameTimes;
+	std::sort(sorted.begin(), sorted.end());
+	const auto percentile = [&sorted](double fraction) {
+		return sorted[static_cast<size_t>(fraction * (sorted.size() - 1))];
+	};
+	summary.medianFrameTime = percentile(0.5);
+	summary.p95FrameTime = percentile(0.95);
+	summary.p99FrameTime = percentile(0.99);
+	summary.maxFrameTime = sorted.back();
+	return summary;
+}
+
+bool FrameProfile::WriteCsv(const std::string& filePath) const {
+	std::ofstream file(filePath, std::ios::trunc);
+	if (!file) {
+		return false;
+	}
+	file << "frame,steps,ms\n";
+	for (size_t i = 0; i < frameTimes.size(); i++) {
+		file << i << ',' << frameSteps[i] << ',' << frameTimes[i] * 1000.0 << '\n';
+	}
+	return static_cast<bool>(file);
+}
@@ -0,0 +1,40 @@
+#ifndef FRAMEPROFILE_H
+#define FRAMEPROFILE_H
+
+#include <string>
+#include <vector>
+
+// All times are in seconds
+struct FrameProfileSummary {
+	size_t frameCount = 0;
+	size_t stepCount = 0;
+	double totalTime = 0.0;
+	double averageFrameTime = 0.0;
+	double averageStepTime = 0.0;
+	double medianFrameTime = 0.0;
+	double p95FrameTime = 0.0;
+	double p99FrameTime = 0.0;
+	double maxFrameTime = 0.0;
+};
+
+//*************************************************************************************
+// FRAME PROFILE
+// The time every frame of a replay took, with the simulation steps it ran. Replaying
+// the same recording on two builds gives two profiles of exactly the same work, which
+// can be compared by their summaries or frame by frame from the CSV files.
+//*************************************************************************************
+
+class FrameProfile {
+private:
+	std::vector<double> frameTimes;
+	std::vector<int> frameSteps;
+
+public:
+	void AddFrame(double frameTime, int numSteps);
+	FrameProfileSummary GetSummary() const;
+
+	// One line per frame: frame number, steps, time in milliseconds
+	bool WriteCsv(const std::string& filePath) const;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include "InputRecording.h"
+#include <algorithm>
+
+static const char RECORDING_MAGIC[4] = { 'G', 'I', 'R', '1' };
+
+static const uint8_t RECORDING_FIXED_POINT = 1 << 0;
+static const uint8_t FRAME_LEVEL_SWITCHED = 1 << 0;
+
+// A frame stores at most this many keys; more presses than that in one frame are dropped
+static const size_t MAX_KEYS_PER_FRAME = 255;
+
+bool InputRecorder::Open(const std::string& filePath, bool isFixedPoint) {
+	stream.open(filePath, std::ios::binary | std::ios::trunc);
+	if (!stream) {
+		return false;
+	}
+	const uint8_t flags = isFixedPoint ? RECORDING_FIXED_POINT : 0;
+	stream.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+	stream.write(reinterpret_cast<const char*>(&flags), sizeof(flags));
+	return static_cast<bool>(stream);
+}
+
+void InputRecorder::RecordFrame(const FrameInput& input) {
+	const uint8_t header[3] = {
+		static_cast<uint8_t>(input.isLevelSwitched ? FRAME_LEVEL_SWITCHED : 0),
+		input.numSteps,
+		static_cast<uint8_t>(std::min(input.keysPressed.size(), MAX_KEYS_PER_FRAME))
+	};
+	stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+	for (uint8_t i = 0; i < header[2]; i++) {
+		const int32_t key = input.keysPressed[i];
+		stream.write(reinterpret_cast<const char*>(&key), sizeof(key));
+	}
+	if (input.numSteps > 0) {
+		stream.write(reinterpret_cast<const char*>(&input.checksum), sizeof(input.checksum));
+	}
+}
+
+void InputRecorder::Close() {
+	stream.close();
+}
+
+bool InputPlayer::Open(const std::string& filePath) {
+	stream.open(filePath, std::ios::binary);
+	char magic[sizeof(RECORDING_MAGIC)] = {};
+	uint8_t flags = 0;
+	stream.read(magic, sizeof(magic));
+	stream.read(reinterpret_cast<char*>(&flags), sizeof(flags));
+	if (!stream || !std::equal(magic, magic + sizeof(magic), RECORDING_MAGIC)) {
+		return false;
+	}
+	isFixedPoint = (flags & RECORDING_FIXED_POINT) != 0;
+	return true;
+}
+
+bool InputPlayer::IsFixedPoint() const {
+	return isFixedPoint;
+}
+
+bool InputPlayer::ReadFrame(FrameInput& input) {
+	uint8_t header[3];
+	if (!stream.read(reinterpret_cast<char*>(header), sizeof(header))) {
+		return false;
+	}
+	input.isLevelSwitched = (header[0] & FRAME_LEVEL_SWITCHED) != 0;
+	input.numSteps = header[1];
+	input.keysPressed.clear();
+	for (uint8_t i = 0; i < header[2]; i++) {
+		int32_t key = 0;
+		stream.read(reinterpret_cast<char*>(&key), sizeof(key));
+		input.keysPressed.push_back(key);
+	}
+	input.checksum = 0;
+	if (input.numSteps > 0) {
+		stream.read(reinterpret_cast<char*>(&input.checksum), sizeof(input.checksum));
+	}
+	return static_cast<bool>(stream);
+}
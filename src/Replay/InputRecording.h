@@ -0,0 +1,54 @@
+#ifndef INPUTRECORDING_H
+#define INPUTRECORDING_H
+
+#include <SDL.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// The input of one frame, and the simulation it led to
+struct FrameInput {
+	std::vector<SDL_Keycode> keysPressed;
+	uint8_t numSteps = 0;				// fixed simulation steps the frame ran
+	bool isLevelSwitched = false;		// a preloaded level was swapped in at the start of the frame
+	uint64_t checksum = 0;				// state checksum after the frame's steps (when it ran any)
+};
+
+//*************************************************************************************
+// INPUT RECORDING
+// A session's input as a compact binary stream, one record per frame, so the session
+// can be replayed step for step. Besides the keys pressed, a frame records what the
+// wall clock decided: how many fixed steps it ran and whether a preloaded level was
+// swapped in. The state checksum after the frame's steps lets a replay tell whether it
+// is still reproducing the recording.
+// Layout: a 4 byte magic and a byte of flags, then per frame a byte of flags, the step
+// count, the key count, the keys (4 bytes each) and, after any steps, the 8 byte checksum.
+//*************************************************************************************
+
+class InputRecorder {
+private:
+	std::ofstream stream;
+
+public:
+	bool Open(const std::string& filePath, bool isFixedPoint);
+	void RecordFrame(const FrameInput& input);
+	void Close();
+};
+
+class InputPlayer {
+private:
+	std::ifstream stream;
+	bool isFixedPoint = false;
+
+public:
+	bool Open(const std::string& filePath);
+
+	// Whether the recording was made with the fixed point simulation
+	bool IsFixedPoint() const;
+
+	// Returns false at the end of the recording
+	bool ReadFrame(FrameInput& input);
+};
+
+#endif
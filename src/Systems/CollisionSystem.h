@@ -0,0 +1,248 @@
+#ifndef COLLISIONSYSTEM_H
+#define COLLISIONSYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Collision/Broadphase.h"
+#include "../Collision/SpatialHashGrid.h"
+#include "../Collision/AABBTreeBroadphase.h"
+#include "../Collision/SweepAndPrune.h"
+#include "../Collision/SpatialIndex.h"
+#include "../EventBus/EventBus.h"
+#include "../Events/CollisionEvent.h"
+#include <memory>
+#include <vector>
+
+// The spatial hash suits evenly spread, similarly sized boxes, the AABB tree uneven ones,
+// and sweep and prune levels that are spread out along x
+enum BroadphaseType {
+	BROADPHASE_SPATIAL_HASH,
+	BROADPHASE_AABB_TREE,
+	BROADPHASE_SWEEP_AND_PRUNE
+};
+
+//*************************************************************************************
+// COLLISION SYSTEM
+// Keeps a broadphase in sync with the colliders and emits a CollisionEvent for every
+// pair of overlapping boxes. Entities without a RigidBodyComponent never move and are
+// inserted as static boxes, which are never tested against each other.
+// Fast movers (RigidBodyComponent::isFastMoving) enter the broadphase with the box
+// swept over their whole step, and their candidate pairs get an exact swept test, so
+// they cannot pass through thin objects between two steps.
+// Sleeping bodies are kept in the broadphase as static boxes, so they are neither moved
+// nor paired with scenery or each other, while awake bodies still find them.
+// Collider layers and masks are read when a collider enters the broadphase; pairs they
+// rule out are dropped there and never reach the narrow phase.
+//*************************************************************************************
+
+class CollisionSystem : public System {
+private:
+	std::unique_ptr<IBroadphase> broadphase;
+	BroadphaseType broadphaseType = BROADPHASE_SPATIAL_HASH;
+	SpatialIndex spatialIndex;
+	std::vector<CollisionPair> pairs;
+
+	// [index = entity id] whether the entity is currently in the broadphase
+	std::vector<bool> isInBroadphase;
+	std::vector<bool> isInSystem;
+
+	// [index = entity id] whether the entity went in as a static box; sleeping bodies are kept static
+	std::vector<bool> isInsertedStatic;
+
+	// [index = entity id] whether the entity is a fast mover whose box was swept this step
+	std::vector<bool> isSwept;
+	std::vector<int> sweptEntities;
+	unsigned int syncedVersion = 0;
+	unsigned int syncedClearCount = 0;
+	bool isSyncRequired = true;
+	bool isFixedPoint = false;
+
+	static AABB ComputeBox(const glm::vec2& position, const TransformComponent& transform, const BoxColliderComponent& collider) {
+		AABB box;
+		box.min = position + collider.offset;
+		box.max = box.min + glm::vec2(collider.width * transform.scale.x, collider.height * transform.scale.y);
+		return box;
+	}
+
+	// Box at the start of the step and how far it moved; boxes without a rigid body never move
+	static AABB GetStepStart(Registry& registry, int entityId) {
+		const auto& transform = registry.GetComponentPool<TransformComponent>()[entityId];
+		const auto& collider = registry.GetComponentPool<BoxColliderComponent>()[entityId];
+		const bool canMove = registry.HasComponent<RigidBodyComponent>(Entity(entityId));
+		return ComputeBox(canMove ? transform.previousPosition : transform.position, transform, collider);
+	}
+
+	static glm::vec2 GetStepDisplacement(Registry& registry, int entityId) {
+		const auto& transform = registry.GetComponentPool<TransformComponent>()[entityId];
+		if (!registry.HasComponent<RigidBodyComponent>(Entity(entityId))) {
+			return glm::vec2(0.0f);
+		}
+		return transform.position - transform.previousPosition;
+	}
+
+	// Insert newcomers and remove entities that left the system (only runs when the entity list changed)
+	void SyncMembership(Registry& registry) {
+		const auto& entities = GetSystemEntities();
+		auto& transforms = registry.GetComponentPool<TransformComponent>();
+		auto& colliders = registry.GetComponentPool<BoxColliderComponent>();
+
+		isInSystem.assign(registry.GetNumEntities(), false);
+		if (isInBroadphase.size() < isInSystem.size()) {
+			isInBroadphase.resize(isInSystem.size(), false);
+			isInsertedStatic.resize(isInSystem.size(), false);
+		}
+
+		for (auto entity : entities) {
+			const int entityId = entity.GetId();
+			isInSystem[entityId] = true;
+			if (!isInBroadphase[entityId]) {
+				// Colliders that can never collide with anything stay out of the broadphase altogether
+				const auto& collider = colliders[entityId];
+				if (collider.layer == COLLISION_LAYER_NONE || collider.mask == COLLISION_LAYER_NONE) {
+					continue;
+				}
+				const bool isStatic = !registry.HasComponent<RigidBodyComponent>(entity) || registry.GetComponent<RigidBodyComponent>(entity).isSleeping;
+				broadphase->Insert(entityId, ComputeBox(transforms[entityId].position, transforms[entityId], collider), isStatic, { collider.layer, collider.mask });
+				isInBroadphase[entityId] = true;
+				isInsertedStatic[entityId] = isStatic;
+			}
+		}
+		for (int entityId = 0; entityId < static_cast<int>(isInBroadphase.size()); entityId++) {
+			if (isInBroadphase[entityId] && (entityId >= static_cast<int>(isInSystem.size()) || !isInSystem[entityId])) {
+				broadphase->Remove(entityId);
+				isInBroadphase[entityId] = false;
+			}
+		}
+
+		syncedVersion = GetVersion();
+		isSyncRequired = false;
+	}
+
+public:
+	CollisionSystem() {
+		RequireComponent<TransformComponent>();
+		RequireComponent<BoxColliderComponent>();
+		broadphase = std::make_unique<SpatialHashGrid>();
+		spatialIndex.SetBroadphase(broadphase.get());
+	}
+
+	// Test swept pairs in Q16.16 instead of float (the deterministic simulation mode)
+	void SetFixedPoint(bool isFixedPoint) {
+		this->isFixedPoint = isFixedPoint;
+	}
+
+	// Swap the broadphase backend; every collider is reinserted on the next update
+	void SetBroadphase(BroadphaseType type) {
+		broadphaseType = type;
+		switch (type) {
+			case BROADPHASE_SPATIAL_HASH:
+				broadphase = std::make_unique<SpatialHashGrid>();
+				break;
+			case BROADPHASE_AABB_TREE:
+				broadphase = std::make_unique<AABBTreeBroadphase>();
+				break;
+			case BROADPHASE_SWEEP_AND_PRUNE:
+				broadphase = std::make_unique<SweepAndPrune>();
+				break;
+		}
+		spatialIndex.SetBroadphase(broadphase.get());
+		isInBroadphase.assign(isInBroadphase.size(), false);
+		isInsertedStatic.assign(isInsertedStatic.size(), false);
+		isSyncRequired = true;
+	}
+
+	// The pairs that collided in the last update
+	const std::vector<CollisionPair>& GetContacts() const {
+		return pairs;
+	}
+
+	// Spatial queries over the colliders; valid after this step's Update and until the next one
+	const SpatialIndex& GetSpatialIndex() const {
+		return spatialIndex;
+	}
+
+	IBroadphase& GetBroadphase() {
+		return *broadphase;
+	}
+
+	void Update(Registry& registry, EventBus& eventBus) {
+		const auto& entities = GetSystemEntities();
+
+		// After a Registry::Clear the ids belong to different entities, so nothing in the broadphase can be kept
+		if (syncedClearCount != GetClearCount()) {
+			SetBroadphase(broadphaseType);
+			syncedClearCount = GetClearCount();
+		}
+		if (isSyncRequired || syncedVersion != GetVersion()) {
+			SyncMembership(registry);
+		}
+
+		// Move the boxes of everything that can move
+		auto& transforms = registry.GetComponentPool<TransformComponent>();
+		auto& colliders = registry.GetComponentPool<BoxColliderComponent>();
+		auto& rigidBodies = registry.GetComponentPool<RigidBodyComponent>();
+		if (isSwept.size() < isInBroadphase.size()) {
+			isSwept.resize(isInBroadphase.size(), false);
+		}
+		for (auto entity : entities) {
+			const int entityId = entity.GetId();
+			if (!isInBroadphase[entityId] || !registry.HasComponent<RigidBodyComponent>(entity)) {
+				continue;
+			}
+			const auto& transform = transforms[entityId];
+			const auto& collider = colliders[entityId];
+			const auto& rigidBody = rigidBodies[entityId];
+			AABB box = ComputeBox(transform.position, transform, collider);
+
+			// Bodies that fell asleep or woke up since the last step change sides
+			if (rigidBody.isSleeping != isInsertedStatic[entityId]) {
+				broadphase->Remove(entityId);
+				broadphase->Insert(entityId, box, rigidBody.isSleeping, { collider.layer, collider.mask });
+				isInsertedStatic[entityId] = rigidBody.isSleeping;
+			}
+			if (rigidBody.isSleeping) {
+				continue;
+			}
+
+			if (rigidBody.isFastMoving) {
+				const AABB start = ComputeBox(transform.previousPosition, transform, collider);
+				box = { glm::min(start.min, box.min), glm::max(start.max, box.max) };
+				isSwept[entityId] = true;
+				sweptEntities.push_back(entityId);
+			}
+			broadphase->Move(entityId, box);
+		}
+
+		pairs.clear();
+		broadphase->FindPairs(pairs);
+
+		// The broadphase already checked the boxes of its pairs; only pairs with a swept box need another look
+		size_t numContacts = 0;
+		for (const auto& pair : pairs) {
+			if (isSwept[pair.entityA] || isSwept[pair.entityB]) {
+				float timeOfImpact;
+				auto sweptOverlaps = isFixedPoint ? SweptOverlapsFixed : SweptOverlaps;
+				if (!sweptOverlaps(GetStepStart(registry, pair.entityA), GetStepDisplacement(registry, pair.entityA), GetStepStart(registry, pair.entityB), GetStepDisplacement(registry, pair.entityB), timeOfImpact)) {
+					continue;
+				}
+			}
+			pairs[numContacts++] = pair;
+			Entity a(pair.entityA);
+			Entity b(pair.entityB);
+			a.registry = &registry;
+			b.registry = &registry;
+			eventBus.EmitEvent<CollisionEvent>(a, b);
+		}
+
+		pairs.resize(numContacts);
+
+		for (const int entityId : sweptEntities) {
+			isSwept[entityId] = false;
+		}
+		sweptEntities.clear();
+	}
+};
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef HIERARCHYSYSTEM_H
+#define HIERARCHYSYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/HierarchyComponent.h"
+#include "../Logger.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+
+//*************************************************************************************
+// HIERARCHY SYSTEM
+// Computes world transforms of entities attached to a parent.
+// Nodes are kept in one contiguous array sorted by depth (roots first), so every parent
+// is processed before its children and the whole hierarchy updates in a single forward pass.
+// A node is only recomputed when its local transform or an ancestor changed.
+//*************************************************************************************
+
+class HierarchySystem : public System {
+private:
+	struct Node {
+		int entityId;
+		int parentIndex;		// index into nodes, -1 for a root
+		int depth;
+		bool isLocalDirty;		// local transform changed since the last update
+		bool isChanged;			// world transform changed during the current update
+		glm::vec2 localPosition;
+		glm::vec2 localScale;
+		double localRotation;
+		glm::vec2 worldPosition;
+		glm::vec2 worldScale;
+		double worldRotation;
+	};
+
+	std::vector<Node> nodes;
+	std::vector<int> nodeIndexByEntity;		// [index = entity id], -1 when the entity is not a node
+	unsigned int builtVersion = 0;
+	bool isBuilt = false;
+
+	int FindNodeIndex(int entityId) const {
+		if (entityId < 0 || entityId >= static_cast<int>(nodeIndexByEntity.size())) {
+			return -1;
+		}
+		return nodeIndexByEntity[entityId];
+	}
+
+	// Depth of an entity in the hierarchy (0 for an entity without a valid parent)
+	// Follows parent links until a root is reached; a loop is reported and treated as a root
+	static int ComputeDepth(Registry& registry, Entity entity, int maxDepth) {
+		int depth = 0;
+		Entity current = entity;
+		while (registry.HasComponent<HierarchyComponent>(current)) {
+			const int parentId = registry.GetComponent<HierarchyComponent>(current).parentId;
+			if (parentId < 0 || parentId >= registry.GetNumEntities()) {
+				break;
+			}
+			current = Entity(parentId);
+			if (++depth > maxDepth) {
+				Logger::Err("Entity id " + std::to_string(entity.GetId()) + " is part of a parent loop");
+				return 0;
+			}
+		}
+		return depth;
+	}
+
+	// Rebuild the depth-sorted node array after entities joined or left the system
+	void Rebuild(Registry& registry) {
+		const auto& entities = GetSystemEntities();
+		const int maxDepth = static_cast<int>(entities.size());
+
+		// Collect the children and the roots they hang from, bucketed by depth
+		std::vector<std::vector<Node>> nodesByDepth(1);
+		std::vector<bool> isRootAdded(registry.GetNumEntities(), false);
+		for (auto entity : entities) {
+			const int depth = ComputeDepth(registry, entity, maxDepth);
+			if (depth == 0) {
+				continue;
+			}
+
+			// A parent without a HierarchyComponent is a root: its world transform is its TransformComponent
+			const auto& hierarchy = entity.GetComponent<HierarchyComponent>();
+			if (depth == 1) {
+				Entity root(hierarchy.parentId);
+				if (!registry.HasComponent<TransformComponent>(root)) {
+					Logger::Err("Parent entity id " + std::to_string(root.GetId()) + " has no TransformComponent");
+					continue;
+				}
+				if (!isRootAdded[root.GetId()]) {
+					isRootAdded[root.GetId()] = true;
+					Node rootNode = {};
+					rootNode.entityId = root.GetId();
+					rootNode.parentIndex = -1;
+					rootNode.isLocalDirty = true;
+					nodesByDepth[0].push_back(rootNode);
+				}
+			}
+
+			if (depth >= static_cast<int>(nodesByDepth.size())) {
+				nodesByDepth.resize(depth + 1);
+			}
+			Node node = {};
+			node.entityId = entity.GetId();
+			node.depth = depth;
+			node.isLocalDirty = true;
+			node.localPosition = hierarchy.localPosition;
+			node.localScale = hierarchy.localScale;
+			node.localRotation = hierarchy.localRotation;
+			nodesByDepth[depth].push_back(node);
+		}
+
+		// Flatten the buckets so the array is sorted by depth
+		nodes.clear();
+		for (auto& bucket : nodesByDepth) {
+			nodes.insert(nodes.end(), bucket.begin(), bucket.end());
+		}
+
+		nodeIndexByEntity.assign(registry.GetNumEntities(), -1);
+		for (int i = 0; i < static_cast<int>(nodes.size()); i++) {
+			nodeIndexByEntity[nodes[i].entityId] = i;
+		}
+
+		// Link children to their parent node (a child whose parent was skipped acts as a root)
+		for (auto& node : nodes) {
+			if (node.depth > 0) {
+				node.parentIndex = FindNodeIndex(registry.GetComponent<HierarchyComponent>(Entity(node.entityId)).parentId);
+			}
+		}
+	}
+
+public:
+	HierarchySystem() {
+		RequireComponent<TransformComponent>();
+		RequireComponent<HierarchyComponent>();
+	}
+
+	// Change the local transform of a child; it and its subtree are recomputed on the next update
+	void SetLocalTransform(Entity entity, glm::vec2 localPosition, glm::vec2 localScale, double localRotation) {
+		auto& hierarchy = entity.GetComponent<HierarchyComponent>();
+		hierarchy.localPosition = localPosition;
+		hierarchy.localScale = localScale;
+		hierarchy.localRotation = localRotation;
+
+		const int index = FindNodeIndex(entity.GetId());
+		if (index >= 0) {
+			Node& node = nodes[index];
+			node.localPosition = localPosition;
+			node.localScale = localScale;
+			node.localRotation = localRotation;
+			node.isLocalDirty = true;
+		}
+	}
+
+	void Update(Registry& registry) {
+		if (!isBuilt || builtVersion != GetVersion()) {
+			Rebuild(registry);
+			builtVersion = GetVersion();
+			isBuilt = true;
+		}
+
+		// Single forward pass: parents always come before their children
+		for (auto& node : nodes) {
+			Entity entity(node.entityId);
+			entity.registry = &registry;
+
+			if (node.parentIndex < 0) {
+				// Roots are driven by other systems (e.g. movement); detect whether they moved
+				const auto& transform = entity.GetComponent<TransformComponent>();
+				node.isChanged = node.isLocalDirty ||
+					transform.position != node.worldPosition ||
+					transform.scale != node.worldScale ||
+					transform.rotation != node.worldRotation;
+				node.worldPosition = transform.position;
+				node.worldScale = transform.scale;
+				node.worldRotation = transform.rotation;
+				node.isLocalDirty = false;
+				continue;
+			}
+
+			const Node& parent = nodes[node.parentIndex];
+			node.isChanged = node.isLocalDirty || parent.isChanged;
+			if (!node.isChanged) {
+				continue;
+			}
+
+			// Scale and rotate the local offset into the parent's space (rotation is in degrees, like SDL)
+			const double radians = glm::radians(parent.worldRotation);
+			const float cosine = static_cast<float>(std::cos(radians));
+			const float sine = static_cast<float>(std::sin(radians));
+			const glm::vec2 offset = node.localPosition * parent.worldScale;
+
+			node.worldPosition = parent.worldPosition + glm::vec2(offset.x * cosine - offset.y * sine, offset.x * sine + offset.y * cosine);
+			node.worldScale = parent.worldScale * node.localScale;
+			node.worldRotation = parent.worldRotation + node.localRotation;
+			node.isLocalDirty = false;
+
+			auto& transform = entity.GetComponent<TransformComponent>();
+			transform.position = node.worldPosition;
+			transform.scale = node.worldScale;
+			transform.rotation = node.worldRotation;
+		}
+	}
+};
+
+#endif
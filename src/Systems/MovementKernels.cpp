@@ -0,0 +1,107 @@
+#include "MovementKernels.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MOVEMENT_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX instructions inside functions compiled for that target;
+// MSVC accepts the intrinsics anywhere
+#if defined(MOVEMENT_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+static void IntegrateScalar(float* positionX, float* positionY, const float* velocityX, const float* velocityY, size_t count, float deltaTime) {
+	for (size_t i = 0; i < count; i++) {
+		positionX[i] += velocityX[i] * deltaTime;
+		positionY[i] += velocityY[i] * deltaTime;
+	}
+}
+
+#if defined(MOVEMENT_KERNELS_X86)
+
+static void IntegrateSse2(float* positionX, float* positionY, const float* velocityX, const float* velocityY, size_t count, float deltaTime) {
+	const __m128 dt = _mm_set1_ps(deltaTime);
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128 x = _mm_loadu_ps(positionX + i);
+		__m128 y = _mm_loadu_ps(positionY + i);
+		x = _mm_add_ps(x, _mm_mul_ps(_mm_loadu_ps(velocityX + i), dt));
+		y = _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(velocityY + i), dt));
+		_mm_storeu_ps(positionX + i, x);
+		_mm_storeu_ps(positionY + i, y);
+	}
+	IntegrateScalar(positionX + i, positionY + i, velocityX + i, velocityY + i, count - i, deltaTime);
+}
+
+AVX2_TARGET static void IntegrateAvx2(float* positionX, float* positionY, const float* velocityX, const float* velocityY, size_t count, float deltaTime) {
+	const __m256 dt = _mm256_set1_ps(deltaTime);
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 x = _mm256_loadu_ps(positionX + i);
+		__m256 y = _mm256_loadu_ps(positionY + i);
+		x = _mm256_add_ps(x, _mm256_mul_ps(_mm256_loadu_ps(velocityX + i), dt));
+		y = _mm256_add_ps(y, _mm256_mul_ps(_mm256_loadu_ps(velocityY + i), dt));
+		_mm256_storeu_ps(positionX + i, x);
+		_mm256_storeu_ps(positionY + i, y);
+	}
+	IntegrateSse2(positionX + i, positionY + i, velocityX + i, velocityY + i, count - i, deltaTime);
+}
+
+static bool CpuSupportsAvx2() {
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	// AVX needs both the CPU flag and the OS saving the YMM registers
+	__cpuid(info, 1);
+	const bool hasOsxsave = (info[2] & (1 << 27)) != 0;
+	const bool hasAvx = (info[2] & (1 << 28)) != 0;
+	if (!hasOsxsave || !hasAvx || (_xgetbv(0) & 0x6) != 0x6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+struct SelectedKernel {
+	IntegrateKernel kernel;
+	const char* name;
+};
+
+static SelectedKernel SelectKernel() {
+#if defined(MOVEMENT_KERNELS_X86)
+	if (CpuSupportsAvx2()) {
+		return { IntegrateAvx2, "avx2" };
+	}
+	// SSE2 is part of the x86-64 baseline and the default target of 32-bit MSVC builds
+	return { IntegrateSse2, "sse2" };
+#else
+	return { IntegrateScalar, "scalar" };
+#endif
+}
+
+static const SelectedKernel& GetSelectedKernel() {
+	static const SelectedKernel selected = SelectKernel();
+	return selected;
+}
+
+void IntegratePositions(float* positionX, float* positionY, const float* velocityX, const float* velocityY, size_t count, float deltaTime) {
+	GetSelectedKernel().kernel(positionX, positionY, velocityX, velocityY, count, deltaTime);
+}
+
+const char* GetIntegrateKernelName() {
+	return GetSelectedKernel().name;
+}
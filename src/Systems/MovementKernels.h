@@ -0,0 +1,21 @@
+#ifndef MOVEMENTKERNELS_H
+#define MOVEMENTKERNELS_H
+
+#include <cstddef>
+
+//*************************************************************************************
+// MOVEMENT KERNELS
+// Integrate positions from velocities over structure-of-arrays streams:
+//   positionX[i] += velocityX[i] * deltaTime, positionY[i] += velocityY[i] * deltaTime
+// A scalar, an SSE2 and an AVX2 version exist; the fastest one the CPU supports is
+// picked the first time IntegratePositions is called.
+//*************************************************************************************
+
+typedef void (*IntegrateKernel)(float* positionX, float* positionY, const float* velocityX, const float* velocityY, size_t count, float deltaTime);
+
+void IntegratePositions(float* positionX, float* positionY, const float* velocityX, const float* velocityY, size_t count, float deltaTime);
+
+// Name of the kernel selected for this CPU ("scalar", "sse2" or "avx2")
+const char* GetIntegrateKernelName();
+
+#endif
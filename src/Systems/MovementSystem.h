@@ -4,26 +4,76 @@
 #include "../ECS/ECS.h"
 #include "../Components/TransformComponent.h"
 #include "../Components/RigidBodyComponent.h"
-//#include "../Logger.h"
+#include "../Math/Fixed.h"
+
+//*************************************************************************************
+// MOVEMENT SYSTEM
+// Moves bodies by their velocity, in one pass over the components. The components stay
+// the only copy of position and velocity, because navigation, steering and collision
+// read and write them directly between the moves. Gathering them into SoA streams for the
+// SIMD kernel and scattering the result back took three times as long as the pass itself
+// (see the movement benchmark), so the kernel is kept for state that lives in streams:
+// particles and projectiles.
+//*************************************************************************************
 
 class MovementSystem : public System {
+private:
+	bool isFixedPoint = false;
+
+	// Fixed point mode: the same pass in Q16.16, so the result does not depend on the CPU or compiler
+	template <typename TEntities>
+	void UpdateFixed(Registry& registry, double deltaTime, const TEntities& entities) {
+		auto& transforms = registry.GetComponentPool<TransformComponent>();
+		auto& rigidBodies = registry.GetComponentPool<RigidBodyComponent>();
+		const Fixed dt(deltaTime);
+
+		for (const auto& entity : entities) {
+			const int entityId = entity.GetId();
+			auto& transform = transforms[entityId];
+			const auto& rigidbody = rigidBodies[entityId];
+			transform.previousPosition = transform.position;
+			transform.position.x = (Fixed(transform.position.x) + Fixed(rigidbody.velocity.x) * dt).ToFloat();
+			transform.position.y = (Fixed(transform.position.y) + Fixed(rigidbody.velocity.y) * dt).ToFloat();
+		}
+	}
+
 public:
 	MovementSystem() {
 		RequireComponent<TransformComponent>();
 		RequireComponent<RigidBodyComponent>();
 	}
 
-	void Update(double deltaTime) {
-		// Loop all entities that the system is interested in
-		for (auto entity : GetSystemEntities()) {
-			// Update entity position based on its velocity
-			auto& transform = entity.GetComponent<TransformComponent>();
-			const auto rigidbody = entity.GetComponent<RigidBodyComponent>();
+	// Integrate in Q16.16 instead of float, so the result does not depend on the CPU or compiler
+	void SetFixedPoint(bool isFixedPoint) {
+		this->isFixedPoint = isFixedPoint;
+	}
+
+	void Update(Registry& registry, double deltaTime) {
+		Update(registry, deltaTime, GetSystemEntities());
+	}
 
-			transform.position.x += rigidbody.velocity.x * deltaTime;
-			transform.position.y += rigidbody.velocity.y * deltaTime;
+	// Moves only the given bodies (e.g. the awake ones); each must have the system's components
+	template <typename TEntities>
+	void Update(Registry& registry, double deltaTime, const TEntities& entities) {
+		if (entities.size() == 0) {
+			return;
+		}
+		if (isFixedPoint) {
+			UpdateFixed(registry, deltaTime, entities);
+			return;
+		}
 
+		auto& transforms = registry.GetComponentPool<TransformComponent>();
+		auto& rigidBodies = registry.GetComponentPool<RigidBodyComponent>();
+		const float dt = static_cast<float>(deltaTime);
 
+		for (const auto& entity : entities) {
+			const int entityId = entity.GetId();
+			auto& transform = transforms[entityId];
+			const auto& rigidbody = rigidBodies[entityId];
+			// Where this step's movement starts; tile and continuous collision sweep from here
+			transform.previousPosition = transform.position;
+			transform.position += rigidbody.velocity * dt;
 		}
 	}
 };
@@ -0,0 +1,223 @@
+#ifndef NAVIGATIONSYSTEM_H
+#define NAVIGATIONSYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/NavigationComponent.h"
+#include "../Components/SteeringComponent.h"
+#include "../Navigation/PathRequestQueue.h"
+#include "../Navigation/FlowFieldCache.h"
+#include "../TileMap/TileMap.h"
+#include "../Math/Fixed.h"
+#include "SleepSystem.h"
+#include <glm/glm.hpp>
+
+//*************************************************************************************
+// NAVIGATION SYSTEM
+// Walks units along tile paths. A unit with a new destination, or whose path was found
+// on an older version of the tile map, asks the PathRequestQueue for a path; once the
+// answer arrives the unit steers its velocity towards one waypoint (tile center) after
+// the other and stops at the destination.
+// Units of a large group that share a destination use its flow field instead: no path
+// of their own, just one lookup per step of the direction from the tile they stand on.
+// Units that are steered get the velocity as their desired one, zero once idle, and the
+// SteeringSystem turns it into their actual velocity.
+// In fixed point mode distances and velocities are computed in Q16.16, so units follow
+// their paths the same way on every compiler and CPU.
+// Runs before the MovementSystem, after the queue's Update has produced this step's answers.
+//*************************************************************************************
+
+class NavigationSystem : public System {
+private:
+	// Distance from the destination at which a unit has arrived
+	static constexpr float ARRIVAL_DISTANCE = 0.5f;
+
+	bool isFixedPoint = false;
+
+	// Point of the unit that follows the path: its collider's center, or its position
+	static glm::vec2 GetCenter(Registry& registry, Entity entity, const TransformComponent& transform) {
+		if (!registry.HasComponent<BoxColliderComponent>(entity)) {
+			return transform.position;
+		}
+		const auto& collider = registry.GetComponentPool<BoxColliderComponent>()[entity.GetId()];
+		return transform.position + collider.offset + 0.5f * glm::vec2(collider.width * transform.scale.x, collider.height * transform.scale.y);
+	}
+
+	static TileCoord ToTileCoord(const TileMap& tileMap, glm::vec2 position) {
+		return { tileMap.ToTile(position.x), tileMap.ToTile(position.y) };
+	}
+
+	// Takes the answers meant for units that still wait for them
+	void ApplyResults(Registry& registry, const PathRequestQueue& pathRequestQueue, const TileMap& tileMap) {
+		auto& navigations = registry.GetComponentPool<NavigationComponent>();
+		const float tileSize = tileMap.GetTileSize();
+		for (size_t i = 0; i < pathRequestQueue.GetNumResults(); i++) {
+			const PathResult& result = pathRequestQueue.GetResult(i);
+			const Entity entity(result.entityId);
+			if (result.entityId >= registry.GetNumEntities() || !registry.HasComponent<NavigationComponent>(entity)) {
+				continue;
+			}
+			auto& navigation = navigations[result.entityId];
+			if (navigation.pathRequestId != result.requestId) {
+				continue;	// superseded by a newer request
+			}
+			navigation.pathRequestId = 0;
+			navigation.waypoints.clear();
+			navigation.waypointIndex = 0;
+			if (!result.isFound) {
+				navigation.hasDestination = false;
+				continue;
+			}
+
+			// The start tile is where the unit already is; the last waypoint is the exact destination
+			for (size_t t = 1; t < result.tiles.size(); t++) {
+				navigation.waypoints.push_back((glm::vec2(result.tiles[t].col, result.tiles[t].row) + 0.5f) * tileSize);
+			}
+			if (navigation.waypoints.empty()) {
+				navigation.waypoints.push_back(navigation.destination);
+			} else {
+				navigation.waypoints.back() = navigation.destination;
+			}
+		}
+	}
+
+	// Length of v; in fixed point mode an integer square root, so no float contraction can change it
+	float Length(glm::vec2 v) const {
+		return isFixedPoint ? FixedVec2(v).Length().ToFloat() : glm::length(v);
+	}
+
+	static glm::vec2 Arrive(NavigationComponent& navigation) {
+		navigation.hasDestination = false;
+		navigation.waypoints.clear();
+		navigation.waypointIndex = 0;
+		return glm::vec2(0.0f);
+	}
+
+	// Velocity towards the destination: full speed while it is more than a step away, then exactly onto it
+	glm::vec2 Approach(NavigationComponent& navigation, glm::vec2 toTarget, float dt) const {
+		if (isFixedPoint) {
+			return ApproachFixed(navigation, FixedVec2(toTarget), Fixed(dt));
+		}
+		const float distance = glm::length(toTarget);
+		if (distance > navigation.speed * dt) {
+			return toTarget * (navigation.speed / distance);
+		}
+		if (distance > ARRIVAL_DISTANCE && dt > 0.0f) {
+			return toTarget / dt;
+		}
+		return Arrive(navigation);
+	}
+
+	static glm::vec2 ApproachFixed(NavigationComponent& navigation, FixedVec2 toTarget, Fixed dt) {
+		const Fixed distance = toTarget.Length();
+		const Fixed speed(navigation.speed);
+		if (distance > speed * dt) {
+			return (toTarget * (speed / distance)).ToVec2();
+		}
+		if (distance > Fixed(ARRIVAL_DISTANCE) && dt > Fixed(0)) {
+			return (toTarget / dt).ToVec2();
+		}
+		return Arrive(navigation);
+	}
+
+	glm::vec2 SteerByFlowField(NavigationComponent& navigation, glm::vec2 center, FlowFieldCache& flowFieldCache, const TileMap& tileMap, float dt) const {
+		const TileCoord goal = ToTileCoord(tileMap, navigation.destination);
+		if (ToTileCoord(tileMap, center) == goal) {
+			return Approach(navigation, navigation.destination - center, dt);
+		}
+		const FlowField* flowField = flowFieldCache.GetField(tileMap, goal);
+		if (!flowField) {
+			return glm::vec2(0.0f);	// built in the next step
+		}
+		const glm::vec2 direction = flowField->GetDirection(center);
+		if (direction == glm::vec2(0.0f)) {
+			navigation.hasDestination = false;	// the destination cannot be reached from here
+		}
+		return isFixedPoint ? (FixedVec2(direction) * Fixed(navigation.speed)).ToVec2() : direction * navigation.speed;
+	}
+
+	static void SetDesiredVelocity(Registry& registry, Entity entity, glm::vec2 velocity) {
+		if (registry.HasComponent<SteeringComponent>(entity)) {
+			registry.GetComponentPool<SteeringComponent>()[entity.GetId()].desiredVelocity = velocity;
+		}
+	}
+
+	static void SetVelocity(Registry& registry, SleepSystem& sleepSystem, Entity entity, RigidBodyComponent& rigidBody, glm::vec2 velocity) {
+		if (rigidBody.isSleeping && velocity != glm::vec2(0.0f)) {
+			sleepSystem.WakeBody(registry, entity);
+		}
+		rigidBody.velocity = velocity;
+		SetDesiredVelocity(registry, entity, velocity);
+	}
+
+public:
+	NavigationSystem() {
+		RequireComponent<TransformComponent>();
+		RequireComponent<RigidBodyComponent>();
+		RequireComponent<NavigationComponent>();
+	}
+
+	// Compute distances and velocities in Q16.16 instead of float (the deterministic simulation mode)
+	void SetFixedPoint(bool isFixedPoint) {
+		this->isFixedPoint = isFixedPoint;
+	}
+
+	void Update(Registry& registry, PathRequestQueue& pathRequestQueue, FlowFieldCache& flowFieldCache, const TileMap& tileMap, SleepSystem& sleepSystem, double deltaTime) {
+		if (GetSystemEntities().empty()) {
+			return;
+		}
+		ApplyResults(registry, pathRequestQueue, tileMap);
+
+		auto& transforms = registry.GetComponentPool<TransformComponent>();
+		auto& rigidBodies = registry.GetComponentPool<RigidBodyComponent>();
+		auto& navigations = registry.GetComponentPool<NavigationComponent>();
+		const float dt = static_cast<float>(deltaTime);
+
+		for (auto entity : GetSystemEntities()) {
+			const int id = entity.GetId();
+			auto& navigation = navigations[id];
+			auto& rigidBody = rigidBodies[id];
+			if (!navigation.hasDestination) {
+				SetDesiredVelocity(registry, entity, glm::vec2(0.0f));
+				continue;
+			}
+			const glm::vec2 center = GetCenter(registry, entity, transforms[id]);
+
+			if (navigation.isUsingFlowField) {
+				SetVelocity(registry, sleepSystem, entity, rigidBody, SteerByFlowField(navigation, center, flowFieldCache, tileMap, dt));
+				continue;
+			}
+
+			if (navigation.pathMapVersion != tileMap.GetVersion()) {
+				navigation.isRepathRequired = true;
+			}
+			if (navigation.isRepathRequired) {
+				navigation.isRepathRequired = false;
+				navigation.pathMapVersion = tileMap.GetVersion();
+				navigation.pathRequestId = pathRequestQueue.Request(id, ToTileCoord(tileMap, center), ToTileCoord(tileMap, navigation.destination));
+				navigation.waypoints.clear();
+				navigation.waypointIndex = 0;
+			}
+
+			// Waiting for a path, or done with it
+			glm::vec2 velocity(0.0f);
+			while (navigation.waypointIndex < navigation.waypoints.size()) {
+				const glm::vec2 toWaypoint = navigation.waypoints[navigation.waypointIndex] - center;
+
+				// Pass intermediate waypoints once within a step's travel; land exactly on the last one
+				if (navigation.waypointIndex + 1 < navigation.waypoints.size() && Length(toWaypoint) <= navigation.speed * dt) {
+					navigation.waypointIndex++;
+					continue;
+				}
+				velocity = Approach(navigation, toWaypoint, dt);
+				break;
+			}
+
+			SetVelocity(registry, sleepSystem, entity, rigidBody, velocity);
+		}
+	}
+};
+
+#endif
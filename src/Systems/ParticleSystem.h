@@ -0,0 +1,263 @@
+#ifndef PARTICLESYSTEM_H
+#define PARTICLESYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/ParticleEmitterComponent.h"
+#include "../AssetManager/AssetStore.h"
+#include "../EventBus/EventBus.h"
+#include "../Events/ProjectileHitEvent.h"
+#include "MovementKernels.h"
+#include <SDL.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//*************************************************************************************
+// PARTICLE SYSTEM
+// Particles are not entities: they live in structure-of-arrays buffers, one buffer per
+// texture. Position, velocity, color and size/life are each a pair of float streams
+// with a pair of rate streams, so every step is five calls of the SIMD integration kernel.
+// Emitters are components; bursts (explosions) can also be emitted directly, and every
+// projectile hit bursts into sparks.
+// Each buffer is drawn with a single SDL_RenderGeometry call, and the vertex and index
+// arrays, like the particle streams, keep their memory once they have grown.
+//*************************************************************************************
+
+class ParticleSystem : public System {
+private:
+	struct ParticleBuffer {
+		std::string assetId;
+		size_t count = 0;
+
+		std::vector<float> positionX, positionY;
+		std::vector<float> velocityX, velocityY;
+		std::vector<float> accelerationX, accelerationY;
+		std::vector<float> colorR, colorG, colorB, colorA;		// 0..255
+		std::vector<float> colorRateR, colorRateG, colorRateB, colorRateA;
+		std::vector<float> size, life;
+		std::vector<float> sizeRate, lifeRate;					// lifeRate is -1: life counts down in seconds
+
+		std::vector<SDL_Vertex> vertices;
+		std::vector<int> indices;
+
+		void Grow(size_t capacity) {
+			for (auto* stream : { &positionX, &positionY, &velocityX, &velocityY, &accelerationX, &accelerationY, &colorR, &colorG, &colorB, &colorA,
+					&colorRateR, &colorRateG, &colorRateB, &colorRateA, &size, &life, &sizeRate, &lifeRate }) {
+				stream->resize(capacity);
+			}
+		}
+
+		// Move the last particle into the hole
+		void Kill(size_t index) {
+			const size_t last = --count;
+			for (auto* stream : { &positionX, &positionY, &velocityX, &velocityY, &accelerationX, &accelerationY, &colorR, &colorG, &colorB, &colorA,
+					&colorRateR, &colorRateG, &colorRateB, &colorRateA, &size, &life, &sizeRate, &lifeRate }) {
+				(*stream)[index] = (*stream)[last];
+			}
+		}
+	};
+
+	std::vector<std::unique_ptr<ParticleBuffer>> buffers;
+	size_t maxParticles;
+	size_t totalCount = 0;
+
+	// Sparks burst at every projectile hit
+	static const int IMPACT_PARTICLES = 12;
+	ParticleEmitterComponent impactEmitter;
+	uint32_t randomState = 0x9E3779B9u;
+
+	// xorshift; uniform in [0, 1)
+	float Random() {
+		randomState ^= randomState << 13;
+		randomState ^= randomState >> 17;
+		randomState ^= randomState << 5;
+		return (randomState >> 8) * (1.0f / 16777216.0f);
+	}
+
+	ParticleBuffer& GetBuffer(const std::string& assetId) {
+		for (auto& buffer : buffers) {
+			if (buffer->assetId == assetId) {
+				return *buffer;
+			}
+		}
+		buffers.push_back(std::make_unique<ParticleBuffer>());
+		buffers.back()->assetId = assetId;
+		return *buffers.back();
+	}
+
+	void Spawn(ParticleBuffer& buffer, const ParticleEmitterComponent& emitter, glm::vec2 position) {
+		if (totalCount == maxParticles) {
+			return;
+		}
+		if (buffer.count == buffer.positionX.size()) {
+			buffer.Grow(std::max<size_t>(1024, buffer.count * 2));
+		}
+
+		const size_t i = buffer.count++;
+		totalCount++;
+
+		const float angle = glm::radians(emitter.direction + (Random() - 0.5f) * emitter.spread);
+		const float speed = emitter.minSpeed + (emitter.maxSpeed - emitter.minSpeed) * Random();
+		const float inverseLifetime = 1.0f / emitter.lifetime;
+
+		buffer.positionX[i] = position.x;
+		buffer.positionY[i] = position.y;
+		buffer.velocityX[i] = std::cos(angle) * speed;
+		buffer.velocityY[i] = std::sin(angle) * speed;
+		buffer.accelerationX[i] = emitter.acceleration.x;
+		buffer.accelerationY[i] = emitter.acceleration.y;
+		buffer.colorR[i] = emitter.startColor.r;
+		buffer.colorG[i] = emitter.startColor.g;
+		buffer.colorB[i] = emitter.startColor.b;
+		buffer.colorA[i] = emitter.startColor.a;
+		buffer.colorRateR[i] = (emitter.endColor.r - emitter.startColor.r) * inverseLifetime;
+		buffer.colorRateG[i] = (emitter.endColor.g - emitter.startColor.g) * inverseLifetime;
+		buffer.colorRateB[i] = (emitter.endColor.b - emitter.startColor.b) * inverseLifetime;
+		buffer.colorRateA[i] = (emitter.endColor.a - emitter.startColor.a) * inverseLifetime;
+		buffer.size[i] = emitter.startSize;
+		buffer.sizeRate[i] = (emitter.endSize - emitter.startSize) * inverseLifetime;
+		buffer.life[i] = emitter.lifetime;
+		buffer.lifeRate[i] = -1.0f;
+	}
+
+	void EmitFromEmitters(Registry& registry, float dt) {
+		auto& transforms = registry.GetComponentPool<TransformComponent>();
+		auto& emitters = registry.GetComponentPool<ParticleEmitterComponent>();
+		for (auto entity : GetSystemEntities()) {
+			auto& emitter = emitters[entity.GetId()];
+			if (!emitter.isEmitting || emitter.rate <= 0.0f) {
+				continue;
+			}
+			emitter.emitAccumulator += emitter.rate * dt;
+			const int spawnCount = static_cast<int>(emitter.emitAccumulator);
+			emitter.emitAccumulator -= spawnCount;
+			EmitBurst(emitter, transforms[entity.GetId()].position + emitter.offset, spawnCount);
+		}
+	}
+
+	static Uint8 ToColorChannel(float value) {
+		return static_cast<Uint8>(std::min(std::max(value, 0.0f), 255.0f));
+	}
+
+public:
+	ParticleSystem(size_t maxParticles = 200000) {
+		RequireComponent<TransformComponent>();
+		RequireComponent<ParticleEmitterComponent>();
+		this->maxParticles = maxParticles;
+		this->impactEmitter = ParticleEmitterComponent("bullet", 0.0f, 0.35f, 60.0f, 180.0f, 0.0f, 360.0f, 4.0f, 1.0f,
+			SDL_Color{ 255, 220, 120, 255 }, SDL_Color{ 255, 80, 20, 0 });
+	}
+
+	void SubscribeToEvents(EventBus& eventBus) {
+		eventBus.SubscribeToEvent<ProjectileHitEvent>(this, &ParticleSystem::OnProjectileHit);
+	}
+
+	void OnProjectileHit(const std::pmr::vector<ProjectileHitEvent>& events) {
+		for (const ProjectileHitEvent& event : events) {
+			EmitBurst(impactEmitter, event.position, IMPACT_PARTICLES);
+		}
+	}
+
+	size_t GetCount() const {
+		return totalCount;
+	}
+
+	// Emit count particles at once, e.g. for an explosion
+	void EmitBurst(const ParticleEmitterComponent& emitter, glm::vec2 position, int count) {
+		ParticleBuffer& buffer = GetBuffer(emitter.assetId);
+		for (int i = 0; i < count; i++) {
+			Spawn(buffer, emitter, position);
+		}
+	}
+
+	void Clear() {
+		for (auto& buffer : buffers) {
+			buffer->count = 0;
+		}
+		totalCount = 0;
+	}
+
+	void Update(Registry& registry, double deltaTime) {
+		const float dt = static_cast<float>(deltaTime);
+
+		// Emit from the emitter components (their pool only exists once a level has added one)
+		if (!GetSystemEntities().empty()) {
+			EmitFromEmitters(registry, dt);
+		}
+
+		for (auto& bufferPointer : buffers) {
+			ParticleBuffer& buffer = *bufferPointer;
+			const size_t count = buffer.count;
+			if (count == 0) {
+				continue;
+			}
+
+			// Integrate every stream with the SIMD kernel: value += rate * dt, two streams per call
+			IntegratePositions(buffer.velocityX.data(), buffer.velocityY.data(), buffer.accelerationX.data(), buffer.accelerationY.data(), count, dt);
+			IntegratePositions(buffer.positionX.data(), buffer.positionY.data(), buffer.velocityX.data(), buffer.velocityY.data(), count, dt);
+			IntegratePositions(buffer.colorR.data(), buffer.colorG.data(), buffer.colorRateR.data(), buffer.colorRateG.data(), count, dt);
+			IntegratePositions(buffer.colorB.data(), buffer.colorA.data(), buffer.colorRateB.data(), buffer.colorRateA.data(), count, dt);
+			IntegratePositions(buffer.size.data(), buffer.life.data(), buffer.sizeRate.data(), buffer.lifeRate.data(), count, dt);
+
+			// Remove dead particles from the back, so every particle moved into a hole has already been checked
+			for (size_t i = count; i-- > 0;) {
+				if (buffer.life[i] <= 0.0f) {
+					buffer.Kill(i);
+					totalCount--;
+				}
+			}
+		}
+	}
+
+	// Draws each texture's particles with one call; interpolation and stepTime place the
+	// particles where they were at the same moment the rest of the scene is drawn at
+	void Render(SDL_Renderer* renderer, AssetStore& assetStore, double interpolation, double stepTime) {
+		const float lag = static_cast<float>((1.0 - interpolation) * stepTime);
+		for (auto& bufferPointer : buffers) {
+			ParticleBuffer& buffer = *bufferPointer;
+			const size_t count = buffer.count;
+			if (count == 0) {
+				continue;
+			}
+
+			// The index pattern never changes, so it is only written for particles not seen before
+			const size_t indexedParticles = buffer.indices.size() / 6;
+			if (indexedParticles < count) {
+				buffer.indices.resize(count * 6);
+				for (size_t i = indexedParticles; i < count; i++) {
+					const int vertex = static_cast<int>(i * 4);
+					int* quad = &buffer.indices[i * 6];
+					quad[0] = vertex;
+					quad[1] = vertex + 1;
+					quad[2] = vertex + 2;
+					quad[3] = vertex;
+					quad[4] = vertex + 2;
+					quad[5] = vertex + 3;
+				}
+			}
+
+			buffer.vertices.resize(count * 4);
+			for (size_t i = 0; i < count; i++) {
+				const float x = buffer.positionX[i] - buffer.velocityX[i] * lag;
+				const float y = buffer.positionY[i] - buffer.velocityY[i] * lag;
+				const float halfSize = buffer.size[i] * 0.5f;
+				const SDL_Color color = { ToColorChannel(buffer.colorR[i]), ToColorChannel(buffer.colorG[i]), ToColorChannel(buffer.colorB[i]), ToColorChannel(buffer.colorA[i]) };
+
+				SDL_Vertex* quad = &buffer.vertices[i * 4];
+				quad[0] = { { x - halfSize, y - halfSize }, color, { 0.0f, 0.0f } };
+				quad[1] = { { x + halfSize, y - halfSize }, color, { 1.0f, 0.0f } };
+				quad[2] = { { x + halfSize, y + halfSize }, color, { 1.0f, 1.0f } };
+				quad[3] = { { x - halfSize, y + halfSize }, color, { 0.0f, 1.0f } };
+			}
+
+			SDL_RenderGeometry(renderer, assetStore.GetTexture(buffer.assetId), buffer.vertices.data(), static_cast<int>(count * 4), buffer.indices.data(), static_cast<int>(count * 6));
+		}
+	}
+};
+
+#endif
@@ -16,7 +16,18 @@ public:
 		RequireComponent<SpriteComponent>();
 	}
 
-	void Update(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore) {
+	// Remember where every renderable entity is before a simulation step moves it
+	void StorePreviousTransforms(Registry& registry) {
+		auto& transforms = registry.GetComponentPool<TransformComponent>();
+		for (auto entity : GetSystemEntities()) {
+			auto& transform = transforms[entity.GetId()];
+			transform.previousPosition = transform.position;
+			transform.previousRotation = transform.rotation;
+		}
+	}
+
+	// interpolation: how far the current frame is between the previous and the latest simulation step [0, 1]
+	void Update(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore, double interpolation) {
 		// todo - sort all the entities of the render system by z index
 		// sorting all entities every frame is a red flag - performance heavy
 		
@@ -47,10 +58,14 @@ public:
 			// Set the source rectangle of original sprite texture
 			SDL_Rect srcRect = sprite.srcRect;
 
+			// Blend the last two simulation states so motion stays smooth between steps
+			const glm::vec2 position = glm::mix(transform.previousPosition, transform.position, static_cast<float>(interpolation));
+			const double rotation = transform.previousRotation + (transform.rotation - transform.previousRotation) * interpolation;
+
 			// Set the destination rectangle with the x,y position to be rendered
 			SDL_Rect dstRect = {
-				static_cast<int>(transform.position.x),
-				static_cast<int>(transform.position.y),
+				static_cast<int>(position.x),
+				static_cast<int>(position.y),
 				static_cast<int>(sprite.width * transform.scale.x),
 				static_cast<int>(sprite.height * transform.scale.y)
 			};
@@ -61,7 +76,7 @@ public:
 				assetStore->GetTexture(sprite.assetId),
 				&srcRect,
 				&dstRect,
-				transform.rotation,
+				rotation,
 				NULL,
 				SDL_FLIP_NONE
 				);
@@ -0,0 +1,230 @@
+#ifndef SLEEPSYSTEM_H
+#define SLEEPSYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Collision/Broadphase.h"
+#include <algorithm>
+#include <vector>
+
+//*************************************************************************************
+// SLEEP SYSTEM
+// Takes resting bodies out of the simulation. A body whose speed stays below the sleep
+// speed for sleepFrames steps is ready to sleep, but bodies in contact form an island,
+// and an island only falls asleep once all of its bodies are ready. Sleeping bodies keep
+// their island, and a contact from an awake body wakes the whole island at once.
+// The MovementSystem only integrates the awake bodies, and the CollisionSystem treats
+// sleeping ones as static boxes, so a parked body costs nothing per step.
+// Code that sets the velocity of a sleeping body must wake it with WakeBody.
+//*************************************************************************************
+
+class SleepSystem : public System {
+private:
+	float sleepSpeed;
+	int sleepFrames;
+
+	std::vector<Entity> awakeBodies;
+	std::vector<int> awakeIndex;		// [index = entity id] position in awakeBodies, -1 while asleep
+	unsigned int syncedVersion = 0;
+
+	// Union-find over the awake bodies, rebuilt every step from the contacts
+	std::vector<int> parent;			// [index = entity id]
+	std::vector<int> islandReadyFrames;	// [index = root entity id] fewest slow frames of any body in the island
+
+	// Sleeping islands: each is a linked list of its bodies
+	std::vector<int> islandOfBody;		// [index = entity id] island slot, -1 while awake
+	std::vector<int> nextInIsland;		// [index = entity id]
+	std::vector<int> islandFirst;		// [index = island slot] first body, -1 for a free slot
+	std::vector<int> freeIslands;
+
+	int FindRoot(int entityId) {
+		while (parent[entityId] != entityId) {
+			parent[entityId] = parent[parent[entityId]];
+			entityId = parent[entityId];
+		}
+		return entityId;
+	}
+
+	void AddAwake(Entity entity) {
+		awakeIndex[entity.GetId()] = static_cast<int>(awakeBodies.size());
+		awakeBodies.push_back(entity);
+	}
+
+	void RemoveAwake(int entityId) {
+		const int index = awakeIndex[entityId];
+		awakeBodies[index] = awakeBodies.back();
+		awakeIndex[awakeBodies[index].GetId()] = index;
+		awakeBodies.pop_back();
+		awakeIndex[entityId] = -1;
+	}
+
+	void EnsureCapacity(int numEntities) {
+		if (static_cast<int>(awakeIndex.size()) < numEntities) {
+			awakeIndex.resize(numEntities, -1);
+			parent.resize(numEntities, 0);
+			islandReadyFrames.resize(numEntities, 0);
+			islandOfBody.resize(numEntities, -1);
+			nextInIsland.resize(numEntities, -1);
+		}
+	}
+
+	// Rebuild the awake list and the island lists after entities joined or left the system
+	void SyncMembership(Registry& registry) {
+		auto& rigidBodies = registry.GetComponentPool<RigidBodyComponent>();
+		EnsureCapacity(registry.GetNumEntities());
+
+		awakeBodies.clear();
+		std::fill(awakeIndex.begin(), awakeIndex.end(), -1);
+		std::fill(islandFirst.begin(), islandFirst.end(), -1);
+		for (auto entity : GetSystemEntities()) {
+			const int entityId = entity.GetId();
+			auto& rigidBody = rigidBodies[entityId];
+			const int island = islandOfBody[entityId];
+			if (rigidBody.isSleeping && island >= 0 && island < static_cast<int>(islandFirst.size())) {
+				nextInIsland[entityId] = islandFirst[island];
+				islandFirst[island] = entityId;
+			} else {
+				rigidBody.isSleeping = false;
+				islandOfBody[entityId] = -1;
+				AddAwake(entity);
+			}
+		}
+
+		freeIslands.clear();
+		for (int island = 0; island < static_cast<int>(islandFirst.size()); island++) {
+			if (islandFirst[island] < 0) {
+				freeIslands.push_back(island);
+			}
+		}
+
+		syncedVersion = GetVersion();
+	}
+
+	void WakeIsland(Registry& registry, int island) {
+		auto& rigidBodies = registry.GetComponentPool<RigidBodyComponent>();
+		for (int entityId = islandFirst[island]; entityId >= 0; entityId = nextInIsland[entityId]) {
+			auto& rigidBody = rigidBodies[entityId];
+			rigidBody.isSleeping = false;
+			rigidBody.slowFrames = 0;
+			islandOfBody[entityId] = -1;
+			Entity entity(entityId);
+			entity.registry = &registry;
+			AddAwake(entity);
+		}
+		islandFirst[island] = -1;
+		freeIslands.push_back(island);
+	}
+
+public:
+	// sleepSpeed in pixels per second
+	SleepSystem(float sleepSpeed = 2.0f, int sleepFrames = 30) {
+		RequireComponent<TransformComponent>();
+		RequireComponent<RigidBodyComponent>();
+		this->sleepSpeed = sleepSpeed;
+		this->sleepFrames = sleepFrames;
+	}
+
+	// Bodies the simulation still has to move this step
+	const std::vector<Entity>& GetAwakeBodies(Registry& registry) {
+		if (syncedVersion != GetVersion()) {
+			SyncMembership(registry);
+		}
+		return awakeBodies;
+	}
+
+	void WakeBody(Registry& registry, Entity entity) {
+		if (syncedVersion != GetVersion()) {
+			SyncMembership(registry);
+		}
+		EnsureCapacity(registry.GetNumEntities());
+		const int island = islandOfBody[entity.GetId()];
+		if (island >= 0) {
+			WakeIsland(registry, island);
+		}
+	}
+
+	// contacts: this step's colliding pairs
+	void Update(Registry& registry, const std::vector<CollisionPair>& contacts) {
+		if (syncedVersion != GetVersion()) {
+			SyncMembership(registry);
+		}
+		// Contacts can name colliders without a body that were created after the last sync
+		EnsureCapacity(registry.GetNumEntities());
+		auto& rigidBodies = registry.GetComponentPool<RigidBodyComponent>();
+
+		// A contact between an awake and a sleeping body wakes the sleeping island first,
+		// so the islands below are built from awake bodies only
+		for (const auto& contact : contacts) {
+			const int islandA = islandOfBody[contact.entityA];
+			const int islandB = islandOfBody[contact.entityB];
+			const bool isAwakeA = awakeIndex[contact.entityA] >= 0;
+			const bool isAwakeB = awakeIndex[contact.entityB] >= 0;
+			if (isAwakeA && islandB >= 0) {
+				WakeIsland(registry, islandB);
+			} else if (isAwakeB && islandA >= 0) {
+				WakeIsland(registry, islandA);
+			}
+		}
+
+		// Count slow frames and start every awake body as its own island
+		const float sleepSpeedSquared = sleepSpeed * sleepSpeed;
+		for (auto entity : awakeBodies) {
+			const int entityId = entity.GetId();
+			auto& rigidBody = rigidBodies[entityId];
+			const float speedSquared = glm::dot(rigidBody.velocity, rigidBody.velocity);
+			rigidBody.slowFrames = (speedSquared < sleepSpeedSquared) ? rigidBody.slowFrames + 1 : 0;
+			parent[entityId] = entityId;
+			islandReadyFrames[entityId] = rigidBody.slowFrames;
+		}
+
+		// Join touching awake bodies; scenery and other colliders without a body do not link islands
+		for (const auto& contact : contacts) {
+			if (awakeIndex[contact.entityA] < 0 || awakeIndex[contact.entityB] < 0) {
+				continue;
+			}
+			const int rootA = FindRoot(contact.entityA);
+			const int rootB = FindRoot(contact.entityB);
+			if (rootA != rootB) {
+				parent[rootB] = rootA;
+				islandReadyFrames[rootA] = std::min(islandReadyFrames[rootA], islandReadyFrames[rootB]);
+			}
+		}
+
+		// Put every island whose bodies have all been slow long enough to sleep
+		auto& transforms = registry.GetComponentPool<TransformComponent>();
+		for (size_t i = 0; i < awakeBodies.size();) {
+			const int entityId = awakeBodies[i].GetId();
+			const int root = FindRoot(entityId);
+			if (islandReadyFrames[root] < sleepFrames) {
+				i++;
+				continue;
+			}
+
+			// The root's island slot is allocated by the first of its bodies to get here
+			if (islandOfBody[root] < 0) {
+				if (freeIslands.empty()) {
+					freeIslands.push_back(static_cast<int>(islandFirst.size()));
+					islandFirst.push_back(-1);
+				}
+				islandOfBody[root] = freeIslands.back();
+				freeIslands.pop_back();
+			}
+			const int island = islandOfBody[root];
+			islandOfBody[entityId] = island;
+			nextInIsland[entityId] = islandFirst[island];
+			islandFirst[island] = entityId;
+
+			auto& rigidBody = rigidBodies[entityId];
+			rigidBody.isSleeping = true;
+			rigidBody.velocity = glm::vec2(0.0f);
+			auto& transform = transforms[entityId];
+			transform.previousPosition = transform.position;
+
+			// Swap-remove brings an unvisited body to position i
+			RemoveAwake(entityId);
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,360 @@
+#ifndef STATECHECKSUMSYSTEM_H
+#define STATECHECKSUMSYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Jobs/JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+// Components that take part in the checksum, in the order divergences are reported
+enum ChecksumComponent {
+	CHECKSUM_TRANSFORM,
+	CHECKSUM_RIGID_BODY,
+	CHECKSUM_BOX_COLLIDER,
+	NUM_CHECKSUM_COMPONENTS
+};
+
+// The checksum of one step with every entity's component hashes, to find where two runs part
+struct ChecksumSnapshot {
+	unsigned int step = 0;
+	uint64_t checksum = 0;
+	std::vector<uint64_t> hashes[NUM_CHECKSUM_COMPONENTS];		// [index = entity id], 0 without the component
+};
+
+struct ChecksumDivergence {
+	bool isDiverged;
+	int entityId;
+	ChecksumComponent component;
+};
+
+//*************************************************************************************
+// STATE CHECKSUM SYSTEM
+// One 64 bit checksum of the simulation state per step, for comparing replays and
+// lockstep peers. Each component of each entity has its own hash of its exact bits, and
+// the checksum is the sum of them all, so an entity that changed is rehashed on its own:
+// subtract its old hashes, add the new ones.
+// Entities that may have changed are marked during the step (the awake bodies before
+// and after it, the hierarchy nodes), and Update rehashes just those, in parallel.
+// Update also rehashes a rotating slice of all entities, so a change made where nothing
+// marks it is still picked up within a few seconds. Entities joining are hashed and
+// added on their own; entities leaving have their hashes subtracted, and only a
+// Registry::Clear rebuilds the whole checksum.
+// When two runs' checksums differ, their snapshots tell the first entity and component
+// that is different.
+//*************************************************************************************
+
+class StateChecksumSystem : public System {
+private:
+	std::vector<uint64_t> hashes[NUM_CHECKSUM_COMPONENTS];
+	uint64_t checksum = 0;
+	unsigned int step = 0;
+	unsigned int syncedVersion = 0;
+	unsigned int syncedClearCount = 0;
+	bool isSynced = false;
+
+	// The system's entities up to numHashedEntities are in the checksum, the last of them lastHashedEntityId.
+	// Entities only join at the end of the list, so while that one is still in place nobody left
+	size_t numHashedEntities = 0;
+	int lastHashedEntityId = -1;
+	std::vector<bool> isInSystem;
+
+	// Entities to rehash this step; markedStep keeps each one in the list once
+	std::vector<int> changedEntities;
+	std::vector<unsigned int> markedStep;		// [index = entity id] step + 1 of the last mark
+	size_t verifyCursor = 0;
+
+	// Every step also rehashes one VERIFY_FRACTION of all entities
+	static const size_t VERIFY_FRACTION = 256;
+	static const size_t REHASH_BATCH_SIZE = 1024;
+
+	// Words of the component's simulation state, an even count; render only state (previous transforms) is left out
+	static int GetWords(const TransformComponent& transform, uint32_t* words) {
+		std::memcpy(words, &transform.position, 8);
+		std::memcpy(words + 2, &transform.scale, 8);
+		std::memcpy(words + 4, &transform.rotation, 8);
+		return 6;
+	}
+
+	static int GetWords(const RigidBodyComponent& rigidBody, uint32_t* words) {
+		std::memcpy(words, &rigidBody.velocity, 8);
+		words[2] = static_cast<uint32_t>(rigidBody.slowFrames);
+		words[3] = (rigidBody.isSleeping ? 1u : 0u) | (rigidBody.isFastMoving ? 2u : 0u);
+		return 4;
+	}
+
+	static int GetWords(const BoxColliderComponent& collider, uint32_t* words) {
+		words[0] = static_cast<uint32_t>(collider.width);
+		words[1] = static_cast<uint32_t>(collider.height);
+		std::memcpy(words + 2, &collider.offset, 8);
+		words[4] = collider.layer;
+		words[5] = collider.mask;
+		return 6;
+	}
+
+	static uint64_t Mix(uint64_t value) {
+		value ^= value >> 32;
+		value *= 0xD6E8FEB86659FD93ull;
+		value ^= value >> 32;
+		value *= 0xD6E8FEB86659FD93ull;
+		value ^= value >> 32;
+		return value;
+	}
+
+	// Lanes are multiplied independently so the hash is not one long chain of multiplies, then
+	// mixed so that swapping state between entities or fields does not cancel out in the sum
+	static uint64_t HashWords(int entityId, ChecksumComponent component, const uint32_t* words, int count) {
+		static const uint64_t laneKeys[4] = { 0x9E3779B97F4A7C15ull, 0xBF58476D1CE4E5B9ull, 0x94D049BB133111EBull, 0xC2B2AE3D27D4EB4Full };
+		uint64_t hash = static_cast<uint64_t>(entityId) << 8 | static_cast<uint64_t>(component);
+		for (int i = 0; i < count; i += 2) {
+			uint64_t lane;
+			std::memcpy(&lane, words + i, 8);
+			hash += (lane ^ laneKeys[i / 2]) * laneKeys[3 - i / 2];
+		}
+		hash = Mix(hash);
+		return hash != 0 ? hash : 1;	// 0 means the entity lacks the component
+	}
+
+	// The pools and type ids of the hashed components, looked up once per batch of entities
+	struct ComponentPools {
+		Pool<TransformComponent>& transforms;
+		Pool<RigidBodyComponent>& rigidBodies;
+		Pool<BoxColliderComponent>& colliders;
+		int transformId;
+		int rigidBodyId;
+		int colliderId;
+	};
+
+	static ComponentPools GetComponentPools(Registry& registry) {
+		return {
+			registry.GetComponentPool<TransformComponent>(), registry.GetComponentPool<RigidBodyComponent>(), registry.GetComponentPool<BoxColliderComponent>(),
+			Component<TransformComponent>::GetId(), Component<RigidBodyComponent>::GetId(), Component<BoxColliderComponent>::GetId()
+		};
+	}
+
+	template <typename TComponent>
+	static uint64_t HashComponent(Pool<TComponent>& pool, bool hasComponent, int entityId, ChecksumComponent component) {
+		if (!hasComponent) {
+			return 0;
+		}
+		uint32_t words[8];
+		const int count = GetWords(pool[entityId], words);
+		return HashWords(entityId, component, words, count);
+	}
+
+	// Rehashes one entity and returns how much the checksum changed
+	uint64_t Rehash(Registry& registry, const ComponentPools& pools, int entityId) {
+		const Signature& signature = registry.GetComponentSignature(Entity(entityId));
+		const uint64_t newHashes[NUM_CHECKSUM_COMPONENTS] = {
+			HashComponent(pools.transforms, signature[pools.transformId], entityId, CHECKSUM_TRANSFORM),
+			HashComponent(pools.rigidBodies, signature[pools.rigidBodyId], entityId, CHECKSUM_RIGID_BODY),
+			HashComponent(pools.colliders, signature[pools.colliderId], entityId, CHECKSUM_BOX_COLLIDER)
+		};
+		uint64_t delta = 0;
+		for (int c = 0; c < NUM_CHECKSUM_COMPONENTS; c++) {
+			delta += newHashes[c] - hashes[c][entityId];
+			hashes[c][entityId] = newHashes[c];
+		}
+		return delta;
+	}
+
+	// Takes an entity's hashes out of the checksum
+	void Unhash(int entityId) {
+		for (int c = 0; c < NUM_CHECKSUM_COMPONENTS; c++) {
+			checksum -= hashes[c][entityId];
+			hashes[c][entityId] = 0;
+		}
+	}
+
+	void Rebuild(Registry& registry) {
+		const size_t numEntities = static_cast<size_t>(registry.GetNumEntities());
+		for (auto& componentHashes : hashes) {
+			componentHashes.assign(numEntities, 0);
+		}
+		markedStep.assign(numEntities, 0);
+		checksum = 0;
+		const ComponentPools pools = GetComponentPools(registry);
+		for (auto entity : GetSystemEntities()) {
+			checksum += Rehash(registry, pools, entity.GetId());
+		}
+		changedEntities.clear();
+		verifyCursor = 0;
+		const auto& entities = GetSystemEntities();
+		numHashedEntities = entities.size();
+		lastHashedEntityId = entities.empty() ? -1 : entities.back().GetId();
+		syncedVersion = GetVersion();
+		syncedClearCount = GetClearCount();
+		isSynced = true;
+	}
+
+	// Subtracts the entities that left and marks the ones that joined, which Update then hashes and adds
+	void SyncMembership(Registry& registry) {
+		const auto& entities = GetSystemEntities();
+		const size_t numEntities = static_cast<size_t>(registry.GetNumEntities());
+		if (hashes[0].size() < numEntities) {
+			for (auto& componentHashes : hashes) {
+				componentHashes.resize(numEntities, 0);
+			}
+			markedStep.resize(numEntities, 0);
+		}
+
+		const bool isOnlyJoined = numHashedEntities == 0 ||
+			(numHashedEntities <= entities.size() && entities[numHashedEntities - 1].GetId() == lastHashedEntityId);
+		if (isOnlyJoined) {
+			for (size_t i = numHashedEntities; i < entities.size(); i++) {
+				Mark(entities[i].GetId());
+			}
+		} else {
+			// Every entity in the checksum has a transform hash; those no longer in the system left
+			isInSystem.assign(numEntities, false);
+			for (auto entity : entities) {
+				isInSystem[entity.GetId()] = true;
+			}
+			changedEntities.erase(std::remove_if(changedEntities.begin(), changedEntities.end(), [this](int entityId) {
+				return !isInSystem[entityId];
+			}), changedEntities.end());
+			for (size_t entityId = 0; entityId < numEntities; entityId++) {
+				if (hashes[CHECKSUM_TRANSFORM][entityId] != 0 && !isInSystem[entityId]) {
+					Unhash(static_cast<int>(entityId));
+				} else if (hashes[CHECKSUM_TRANSFORM][entityId] == 0 && isInSystem[entityId]) {
+					Mark(static_cast<int>(entityId));
+				}
+			}
+			verifyCursor = 0;
+		}
+
+		numHashedEntities = entities.size();
+		lastHashedEntityId = entities.empty() ? -1 : entities.back().GetId();
+		syncedVersion = GetVersion();
+	}
+
+	void Mark(int entityId) {
+		if (markedStep[entityId] != step + 1) {
+			markedStep[entityId] = step + 1;
+			changedEntities.push_back(entityId);
+		}
+	}
+
+public:
+	StateChecksumSystem() {
+		RequireComponent<TransformComponent>();
+	}
+
+	// Entities that may change (or have changed) during the current step
+	template <typename TEntities>
+	void MarkChanged(const TEntities& entities) {
+		if (!isSynced || syncedClearCount != GetClearCount()) {
+			return;		// Update rebuilds everything anyway
+		}
+		for (const auto& entity : entities) {
+			// Entities that joined since the last update are hashed when Update adds them
+			if (entity.GetId() < static_cast<int>(markedStep.size())) {
+				Mark(entity.GetId());
+			}
+		}
+	}
+
+	// Call once at the end of every simulation step
+	void Update(Registry& registry, JobSystem& jobSystem) {
+		if (!isSynced || syncedClearCount != GetClearCount()) {
+			Rebuild(registry);
+			step++;
+			return;
+		}
+		if (syncedVersion != GetVersion()) {
+			SyncMembership(registry);
+		}
+
+		const auto& entities = GetSystemEntities();
+		const size_t verifyCount = (entities.size() + VERIFY_FRACTION - 1) / VERIFY_FRACTION;
+		for (size_t i = 0; i < verifyCount; i++) {
+			verifyCursor = verifyCursor < entities.size() ? verifyCursor : 0;
+			Mark(entities[verifyCursor++].GetId());
+		}
+
+		// Addition is commutative, so the jobs' partial sums add up to the same checksum in any order
+		std::atomic<uint64_t> delta{ 0 };
+		jobSystem.ParallelFor(changedEntities.size(), REHASH_BATCH_SIZE, [&](size_t begin, size_t end) {
+			const ComponentPools pools = GetComponentPools(registry);
+			uint64_t batchDelta = 0;
+			for (size_t i = begin; i < end; i++) {
+				batchDelta += Rehash(registry, pools, changedEntities[i]);
+			}
+			delta += batchDelta;
+		});
+		checksum += delta;
+		changedEntities.clear();
+		step++;
+	}
+
+	uint64_t GetChecksum() const {
+		return checksum;
+	}
+
+	unsigned int GetStep() const {
+		return step;
+	}
+
+	void TakeSnapshot(ChecksumSnapshot& snapshot) const {
+		snapshot.step = step;
+		snapshot.checksum = checksum;
+		for (int c = 0; c < NUM_CHECKSUM_COMPONENTS; c++) {
+			snapshot.hashes[c] = hashes[c];
+		}
+	}
+
+	// First entity (lowest id) whose components differ between two snapshots
+	static ChecksumDivergence FindFirstDivergence(const ChecksumSnapshot& a, const ChecksumSnapshot& b) {
+		const size_t numEntities = std::max(a.hashes[0].size(), b.hashes[0].size());
+		for (size_t entityId = 0; entityId < numEntities; entityId++) {
+			for (int c = 0; c < NUM_CHECKSUM_COMPONENTS; c++) {
+				const uint64_t hashA = entityId < a.hashes[c].size() ? a.hashes[c][entityId] : 0;
+				const uint64_t hashB = entityId < b.hashes[c].size() ? b.hashes[c][entityId] : 0;
+				if (hashA != hashB) {
+					return { true, static_cast<int>(entityId), static_cast<ChecksumComponent>(c) };
+				}
+			}
+		}
+		return { false, -1, NUM_CHECKSUM_COMPONENTS };
+	}
+
+	static const char* GetComponentName(ChecksumComponent component) {
+		static const char* names[NUM_CHECKSUM_COMPONENTS] = { "TransformComponent", "RigidBodyComponent", "BoxColliderComponent" };
+		return component < NUM_CHECKSUM_COMPONENTS ? names[component] : "none";
+	}
+
+	// Binary snapshot files, to compare runs that did not happen in the same process
+	static void WriteSnapshot(std::ostream& stream, const ChecksumSnapshot& snapshot) {
+		const uint64_t numEntities = snapshot.hashes[0].size();
+		stream.write(reinterpret_cast<const char*>(&snapshot.step), sizeof(snapshot.step));
+		stream.write(reinterpret_cast<const char*>(&snapshot.checksum), sizeof(snapshot.checksum));
+		stream.write(reinterpret_cast<const char*>(&numEntities), sizeof(numEntities));
+		for (const auto& componentHashes : snapshot.hashes) {
+			stream.write(reinterpret_cast<const char*>(componentHashes.data()), numEntities * sizeof(uint64_t));
+		}
+	}
+
+	static bool ReadSnapshot(std::istream& stream, ChecksumSnapshot& snapshot) {
+		uint64_t numEntities = 0;
+		stream.read(reinterpret_cast<char*>(&snapshot.step), sizeof(snapshot.step));
+		stream.read(reinterpret_cast<char*>(&snapshot.checksum), sizeof(snapshot.checksum));
+		stream.read(reinterpret_cast<char*>(&numEntities), sizeof(numEntities));
+		if (!stream) {
+			return false;
+		}
+		for (auto& componentHashes : snapshot.hashes) {
+			componentHashes.resize(numEntities);
+			stream.read(reinterpret_cast<char*>(componentHashes.data()), numEntities * sizeof(uint64_t));
+		}
+		return static_cast<bool>(stream);
+	}
+};
+
+#endif
@@ -0,0 +1,284 @@
+#ifndef STEERINGSYSTEM_H
+#define STEERINGSYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/SteeringComponent.h"
+#include "../TileMap/TileMap.h"
+#include "../Jobs/JobSystem.h"
+#include "../Math/Fixed.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//*************************************************************************************
+// STEERING SYSTEM
+// Crowd steering for groups of units: separation from neighbours closer than the
+// neighbour radius, alignment with their average velocity, and avoidance of solid tiles
+// one neighbour radius ahead. Agents are steered from their component's desired
+// velocity, which the NavigationSystem sets every step, never from last step's steered
+// velocity, so an agent that wants to stand still only moves to make room.
+// Neighbours are found through a spatial hash rebuilt every step: the agents are
+// counting sorted by cell into packed arrays, so an agent reads its 3x3 cells of
+// neighbours from contiguous memory. The agents are then steered in parallel batches;
+// each job writes only its own agents' velocities.
+// In fixed point mode the forces are summed in Q16.16 with integer lengths, so the
+// velocities do not depend on the compiler or CPU.
+// Runs after the NavigationSystem and before the MovementSystem.
+//*************************************************************************************
+
+class SteeringSystem : public System {
+private:
+	float neighborRadius;
+	float inverseCellSize;
+	unsigned int bucketMask = 0;
+	bool isFixedPoint = false;
+
+	// Agents of this step, in system order
+	std::vector<glm::vec2> agentCenters;
+	std::vector<int> agentCellX;
+	std::vector<int> agentCellY;
+	std::vector<unsigned int> agentBucket;
+
+	// The spatial hash: agents sorted by bucket, with their state packed alongside
+	std::vector<int> bucketStart;		// [bucket] first sorted agent; bucketStart[bucket + 1] ends it
+	std::vector<int> bucketFill;
+	std::vector<int> sortedEntityIds;
+	std::vector<int> sortedCellX;
+	std::vector<int> sortedCellY;
+	std::vector<float> sortedX, sortedY;
+	std::vector<float> sortedVelocityX, sortedVelocityY;	// current velocities, which neighbours align with
+
+	// Agents per job: enough neighbour scans to outweigh taking a batch
+	static const size_t STEERING_BATCH_SIZE = 256;
+
+	int ToCell(float coordinate) const {
+		return static_cast<int>(std::floor(coordinate * inverseCellSize));
+	}
+
+	unsigned int HashCell(int cellX, int cellY) const {
+		return ((static_cast<unsigned int>(cellX) * 73856093u) ^ (static_cast<unsigned int>(cellY) * 19349663u)) & bucketMask;
+	}
+
+	static glm::vec2 GetCenter(Registry& registry, Entity entity, const TransformComponent& transform) {
+		if (!registry.HasComponent<BoxColliderComponent>(entity)) {
+			return transform.position;
+		}
+		const auto& collider = registry.GetComponentPool<BoxColliderComponent>()[entity.GetId()];
+		return transform.position + collider.offset + 0.5f * glm::vec2(collider.width * transform.scale.x, collider.height * transform.scale.y);
+	}
+
+	void BuildHash(Registry& registry) {
+		const auto& entities = GetSystemEntities();
+		const size_t numAgents = entities.size();
+
+		// Twice as many buckets as agents keeps the buckets short
+		unsigned int bucketCount = 1;
+		while (bucketCount < 2 * numAgents) {
+			bucketCount <<= 1;
+		}
+		bucketMask = bucketCount - 1;
+		if (bucketStart.size() < bucketCount + 1) {
+			bucketStart.resize(bucketCount + 1);
+			bucketFill.resize(bucketCount);
+		}
+		if (sortedEntityIds.size() < numAgents) {
+			agentCenters.resize(numAgents);
+			agentCellX.resize(numAgents);
+			agentCellY.resize(numAgents);
+			agentBucket.resize(numAgents);
+			sortedEntityIds.resize(numAgents);
+			sortedCellX.resize(numAgents);
+			sortedCellY.resize(numAgents);
+			sortedX.resize(numAgents);
+			sortedY.resize(numAgents);
+			sortedVelocityX.resize(numAgents);
+			sortedVelocityY.resize(numAgents);
+		}
+
+		auto& transforms = registry.GetComponentPool<TransformComponent>();
+		auto& rigidBodies = registry.GetComponentPool<RigidBodyComponent>();
+		std::fill(bucketStart.begin(), bucketStart.begin() + bucketCount + 1, 0);
+		for (size_t i = 0; i < numAgents; i++) {
+			agentCenters[i] = GetCenter(registry, entities[i], transforms[entities[i].GetId()]);
+			agentCellX[i] = ToCell(agentCenters[i].x);
+			agentCellY[i] = ToCell(agentCenters[i].y);
+			agentBucket[i] = HashCell(agentCellX[i], agentCellY[i]);
+			bucketStart[agentBucket[i] + 1]++;
+		}
+		for (unsigned int bucket = 0; bucket < bucketCount; bucket++) {
+			bucketStart[bucket + 1] += bucketStart[bucket];
+		}
+		std::copy(bucketStart.begin(), bucketStart.begin() + bucketCount, bucketFill.begin());
+		for (size_t i = 0; i < numAgents; i++) {
+			const int entityId = entities[i].GetId();
+			const int slot = bucketFill[agentBucket[i]]++;
+			sortedEntityIds[slot] = entityId;
+			sortedCellX[slot] = agentCellX[i];
+			sortedCellY[slot] = agentCellY[i];
+			sortedX[slot] = agentCenters[i].x;
+			sortedY[slot] = agentCenters[i].y;
+			sortedVelocityX[slot] = rigidBodies[entityId].velocity.x;
+			sortedVelocityY[slot] = rigidBodies[entityId].velocity.y;
+		}
+	}
+
+	// Steered velocity of the sorted agent i
+	glm::vec2 Steer(int i, const SteeringComponent& steering, const TileMap& tileMap) const {
+		const glm::vec2 position(sortedX[i], sortedY[i]);
+		const glm::vec2 desired = steering.desiredVelocity;
+		const float radiusSquared = neighborRadius * neighborRadius;
+
+		glm::vec2 separation(0.0f);
+		glm::vec2 neighborVelocity(0.0f);
+		int numNeighbors = 0;
+		for (int y = sortedCellY[i] - 1; y <= sortedCellY[i] + 1; y++) {
+			for (int x = sortedCellX[i] - 1; x <= sortedCellX[i] + 1; x++) {
+				const unsigned int bucket = HashCell(x, y);
+				for (int j = bucketStart[bucket]; j < bucketStart[bucket + 1]; j++) {
+					if (j == i || sortedCellX[j] != x || sortedCellY[j] != y) {
+						continue;
+					}
+					const glm::vec2 away = position - glm::vec2(sortedX[j], sortedY[j]);
+					const float distanceSquared = away.x * away.x + away.y * away.y;
+					if (distanceSquared >= radiusSquared) {
+						continue;
+					}
+					// Push harder the closer the neighbour; agents on the same spot split by index
+					const float distance = std::sqrt(distanceSquared);
+					const glm::vec2 direction = distance > 0.0f ? away / distance : glm::vec2(i < j ? -1.0f : 1.0f, 0.0f);
+					separation += direction * (1.0f - distance / neighborRadius);
+					neighborVelocity += glm::vec2(sortedVelocityX[j], sortedVelocityY[j]);
+					numNeighbors++;
+				}
+			}
+		}
+
+		glm::vec2 steered = desired + separation * (steering.separationWeight * steering.maxSpeed);
+		if (numNeighbors > 0) {
+			steered += (neighborVelocity / static_cast<float>(numNeighbors) - desired) * steering.alignmentWeight;
+		}
+
+		// Probe one neighbour radius ahead; a solid tile there pushes the agent away from its center
+		const float speed = glm::length(desired);
+		if (speed > 0.0f && tileMap.GetNumCols() > 0) {
+			const glm::vec2 probe = position + desired * (neighborRadius / speed);
+			const int col = tileMap.ToTile(probe.x);
+			const int row = tileMap.ToTile(probe.y);
+			if (tileMap.IsSolid(col, row)) {
+				const glm::vec2 tileCenter = (glm::vec2(col, row) + 0.5f) * tileMap.GetTileSize();
+				const glm::vec2 away = position - tileCenter;
+				const float distance = glm::length(away);
+				if (distance > 0.0f) {
+					steered += away * (steering.avoidanceWeight * steering.maxSpeed / distance);
+				}
+			}
+		}
+
+		const float steeredSpeed = glm::length(steered);
+		if (steeredSpeed > steering.maxSpeed) {
+			steered *= steering.maxSpeed / steeredSpeed;
+		}
+		return steered;
+	}
+
+	// Steer in Q16.16: the same forces, with integer square roots for every length
+	glm::vec2 SteerFixed(int i, const SteeringComponent& steering, const TileMap& tileMap) const {
+		const FixedVec2 position(glm::vec2(sortedX[i], sortedY[i]));
+		const FixedVec2 desired(steering.desiredVelocity);
+		const Fixed radius(neighborRadius);
+		const Fixed maxSpeed(steering.maxSpeed);
+
+		FixedVec2 separation;
+		FixedVec2 neighborVelocity;
+		int numNeighbors = 0;
+		for (int y = sortedCellY[i] - 1; y <= sortedCellY[i] + 1; y++) {
+			for (int x = sortedCellX[i] - 1; x <= sortedCellX[i] + 1; x++) {
+				const unsigned int bucket = HashCell(x, y);
+				for (int j = bucketStart[bucket]; j < bucketStart[bucket + 1]; j++) {
+					if (j == i || sortedCellX[j] != x || sortedCellY[j] != y) {
+						continue;
+					}
+					const FixedVec2 away = position - FixedVec2(glm::vec2(sortedX[j], sortedY[j]));
+					const Fixed distance = away.Length();
+					if (distance >= radius) {
+						continue;
+					}
+					const FixedVec2 direction = distance > Fixed(0) ? away / distance : FixedVec2(Fixed(i < j ? -1 : 1), Fixed(0));
+					separation = separation + direction * (Fixed(1) - distance / radius);
+					neighborVelocity = neighborVelocity + FixedVec2(glm::vec2(sortedVelocityX[j], sortedVelocityY[j]));
+					numNeighbors++;
+				}
+			}
+		}
+
+		FixedVec2 steered = desired + separation * (Fixed(steering.separationWeight) * maxSpeed);
+		if (numNeighbors > 0) {
+			steered = steered + (neighborVelocity / Fixed(numNeighbors) - desired) * Fixed(steering.alignmentWeight);
+		}
+
+		const Fixed speed = desired.Length();
+		if (speed > Fixed(0) && tileMap.GetNumCols() > 0) {
+			const FixedVec2 probe = position + desired * (radius / speed);
+			const int col = tileMap.ToTile(probe.x.ToFloat());
+			const int row = tileMap.ToTile(probe.y.ToFloat());
+			if (tileMap.IsSolid(col, row)) {
+				const Fixed tileSize(tileMap.GetTileSize());
+				const FixedVec2 tileCenter = FixedVec2(Fixed(col) * tileSize, Fixed(row) * tileSize) + FixedVec2(tileSize, tileSize) * Fixed(0.5f);
+				const FixedVec2 away = position - tileCenter;
+				const Fixed distance = away.Length();
+				if (distance > Fixed(0)) {
+					steered = steered + away * (Fixed(steering.avoidanceWeight) * maxSpeed / distance);
+				}
+			}
+		}
+
+		const Fixed steeredSpeed = steered.Length();
+		if (steeredSpeed > maxSpeed) {
+			steered = steered * (maxSpeed / steeredSpeed);
+		}
+		return steered.ToVec2();
+	}
+
+public:
+	SteeringSystem(float neighborRadius = 48.0f) {
+		RequireComponent<TransformComponent>();
+		RequireComponent<RigidBodyComponent>();
+		RequireComponent<SteeringComponent>();
+		this->neighborRadius = neighborRadius;
+		this->inverseCellSize = 1.0f / neighborRadius;
+	}
+
+	// Steer in Q16.16 instead of float (the deterministic simulation mode)
+	void SetFixedPoint(bool isFixedPoint) {
+		this->isFixedPoint = isFixedPoint;
+	}
+
+	void Update(Registry& registry, const TileMap& tileMap, JobSystem& jobSystem) {
+		const size_t numAgents = GetSystemEntities().size();
+		if (numAgents == 0) {
+			return;
+		}
+		BuildHash(registry);
+
+		auto& rigidBodies = registry.GetComponentPool<RigidBodyComponent>();
+		auto& steerings = registry.GetComponentPool<SteeringComponent>();
+		jobSystem.ParallelFor(numAgents, STEERING_BATCH_SIZE, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const int entityId = sortedEntityIds[i];
+				auto& rigidBody = rigidBodies[entityId];
+
+				// Sleeping agents still keep others away, but are left asleep themselves
+				if (rigidBody.isSleeping) {
+					continue;
+				}
+				rigidBody.velocity = isFixedPoint ? SteerFixed(static_cast<int>(i), steerings[entityId], tileMap) : Steer(static_cast<int>(i), steerings[entityId], tileMap);
+			}
+		});
+	}
+};
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef TILECOLLISIONSYSTEM_H
+#define TILECOLLISIONSYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../TileMap/TileMap.h"
+#include "../Math/Fixed.h"
+#include <cmath>
+
+//*************************************************************************************
+// TILE COLLISION SYSTEM
+// Stops moving boxes at solid tiles. Each step's movement is undone and replayed one axis
+// at a time, x first: the box's leading edge is walked over the tile columns (or rows)
+// it crosses, and each one is checked in the solid bit-grid of the tile map. The box
+// stops against the first solid tile and loses its velocity along that axis.
+// In the fixed point mode the same sweep runs on Q16.16 numbers, so where a box stops
+// does not depend on how the compiler rounds float code.
+// Runs right after the MovementSystem.
+//*************************************************************************************
+
+class TileCollisionSystem : public System {
+private:
+	bool isFixedPoint = false;
+
+	// Tile index arithmetic for both number types; the fixed point versions divide the raw integers exactly
+	static int FloorDivide(float value, float tileSize) { return static_cast<int>(std::floor(value / tileSize)); }
+	static int CeilDivide(float value, float tileSize) { return static_cast<int>(std::ceil(value / tileSize)); }
+	static int FloorDivide(Fixed value, Fixed tileSize) {
+		const int quotient = value.raw / tileSize.raw;
+		return (value.raw % tileSize.raw != 0 && value.raw < 0) ? quotient - 1 : quotient;
+	}
+	static int CeilDivide(Fixed value, Fixed tileSize) {
+		const int quotient = value.raw / tileSize.raw;
+		return (value.raw % tileSize.raw != 0 && value.raw > 0) ? quotient + 1 : quotient;
+	}
+	static float ToFloat(float value) { return value; }
+	static float ToFloat(Fixed value) { return value.ToFloat(); }
+
+	// Moves the box's [boxMin, boxMax) span along one axis by delta and returns how far it can go.
+	// The other axis spans tiles crossMin..crossMax; isX selects which axis is moving.
+	template <typename T>
+	static T Sweep(const TileMap& tileMap, T tileSize, T boxMin, T boxMax, T delta, int crossMin, int crossMax, bool isX) {
+		if (delta > T(0)) {
+			// Tiles the leading edge newly enters; tiles the box already overlaps never block it
+			const int first = CeilDivide(boxMax, tileSize);
+			const int last = CeilDivide(boxMax + delta, tileSize) - 1;
+			for (int tile = first; tile <= last; tile++) {
+				if (isX ? tileMap.IsAreaSolid(tile, crossMin, tile, crossMax) : tileMap.IsAreaSolid(crossMin, tile, crossMax, tile)) {
+					return T(tile) * tileSize - boxMax;
+				}
+			}
+		} else if (delta < T(0)) {
+			const int first = FloorDivide(boxMin, tileSize) - 1;
+			const int last = FloorDivide(boxMin + delta, tileSize);
+			for (int tile = first; tile >= last; tile--) {
+				if (isX ? tileMap.IsAreaSolid(tile, crossMin, tile, crossMax) : tileMap.IsAreaSolid(crossMin, tile, crossMax, tile)) {
+					return T(tile + 1) * tileSize - boxMin;
+				}
+			}
+		}
+		return delta;
+	}
+
+	// Tiles covered by the [min, max) span
+	template <typename T>
+	static void ToTileSpan(T tileSize, T min, T max, int& first, int& last) {
+		first = FloorDivide(min, tileSize);
+		last = CeilDivide(max, tileSize) - 1;
+	}
+
+	// Replays the body's step one axis at a time, computing in T (float or Fixed)
+	template <typename T>
+	static void Resolve(const TileMap& tileMap, TransformComponent& transform, const BoxColliderComponent& collider, RigidBodyComponent& rigidBody) {
+		const T startX(transform.previousPosition.x);
+		const T startY(transform.previousPosition.y);
+		const T deltaX = T(transform.position.x) - startX;
+		const T deltaY = T(transform.position.y) - startY;
+		if (deltaX == T(0) && deltaY == T(0)) {
+			return;
+		}
+
+		// Box where the step started
+		const T tileSize(tileMap.GetTileSize());
+		const T sizeX(collider.width * transform.scale.x);
+		const T sizeY(collider.height * transform.scale.y);
+		T boxMinX = startX + T(collider.offset.x);
+		const T boxMinY = startY + T(collider.offset.y);
+		int row0, row1, col0, col1;
+
+		ToTileSpan(tileSize, boxMinY, boxMinY + sizeY, row0, row1);
+		const T moveX = Sweep(tileMap, tileSize, boxMinX, boxMinX + sizeX, deltaX, row0, row1, true);
+		if (moveX != deltaX) {
+			rigidBody.velocity.x = 0.0f;
+		}
+		boxMinX += moveX;
+
+		ToTileSpan(tileSize, boxMinX, boxMinX + sizeX, col0, col1);
+		const T moveY = Sweep(tileMap, tileSize, boxMinY, boxMinY + sizeY, deltaY, col0, col1, false);
+		if (moveY != deltaY) {
+			rigidBody.velocity.y = 0.0f;
+		}
+
+		transform.position = glm::vec2(ToFloat(startX + moveX), ToFloat(startY + moveY));
+	}
+
+public:
+	TileCollisionSystem() {
+		RequireComponent<TransformComponent>();
+		RequireComponent<BoxColliderComponent>();
+		RequireComponent<RigidBodyComponent>();
+	}
+
+	void SetFixedPoint(bool isFixedPoint) {
+		this->isFixedPoint = isFixedPoint;
+	}
+
+	void Update(Registry& registry, const TileMap& tileMap) {
+		const auto& entities = GetSystemEntities();
+		if (entities.empty() || tileMap.GetNumCols() == 0) {
+			return;
+		}
+
+		auto& transforms = registry.GetComponentPool<TransformComponent>();
+		auto& colliders = registry.GetComponentPool<BoxColliderComponent>();
+		auto& rigidBodies = registry.GetComponentPool<RigidBodyComponent>();
+
+		for (auto entity : entities) {
+			const int entityId = entity.GetId();
+			auto& rigidBody = rigidBodies[entityId];
+			if (rigidBody.isSleeping) {
+				continue;
+			}
+			if (isFixedPoint) {
+				Resolve<Fixed>(tileMap, transforms[entityId], colliders[entityId], rigidBody);
+			} else {
+				Resolve<float>(tileMap, transforms[entityId], colliders[entityId], rigidBody);
+			}
+		}
+	}
+};
+
+#endif
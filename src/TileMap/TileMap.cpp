@@ -0,0 +1,123 @@
+#include "TileMap.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+void TileMap::SetTileProperties(int tileType, const TileProperties& properties) {
+	tileProperties[tileType] = properties;
+
+	// Refresh the tiles of this type already on the map
+	for (int row = 0; row < numRows; row++) {
+		for (int col = 0; col < numCols; col++) {
+			if (tileTypes[row * numCols + col] == tileType) {
+				SetTileType(col, row, tileType);
+			}
+		}
+	}
+}
+
+const TileProperties& TileMap::GetTileProperties(int tileType) const {
+	return tileProperties[tileType];
+}
+
+bool TileMap::LoadFromFile(const std::string& filePath, int numCols, int numRows, float tileSize) {
+	std::ifstream mapFile(filePath);
+	if (!mapFile) {
+		return false;
+	}
+
+	Create(numCols, numRows, tileSize);
+	for (int row = 0; row < numRows; row++) {
+		for (int col = 0; col < numCols; col++) {
+			char digits[2] = { '0', '0' };
+			mapFile.get(digits[0]);
+			mapFile.get(digits[1]);
+			mapFile.ignore();
+			SetTileType(col, row, (digits[0] - '0') * 10 + (digits[1] - '0'));
+		}
+	}
+
+	version++;
+	return true;
+}
+
+void TileMap::Create(int numCols, int numRows, float tileSize) {
+	this->numCols = numCols;
+	this->numRows = numRows;
+	this->tileSize = tileSize;
+	wordsPerRow = (numCols + 63) / 64;
+	tileTypes.assign(numCols * numRows, 0);
+	solidBits.assign(wordsPerRow * numRows, 0);
+
+	if (tileProperties[0].isSolid) {
+		for (int row = 0; row < numRows; row++) {
+			for (int col = 0; col < numCols; col++) {
+				SetTileType(col, row, 0);
+			}
+		}
+	}
+	version++;
+}
+
+void TileMap::Clear() {
+	numCols = 0;
+	numRows = 0;
+	wordsPerRow = 0;
+	tileTypes.clear();
+	solidBits.clear();
+	version++;
+}
+
+void TileMap::SetTileType(int col, int row, int tileType) {
+	tileType = std::clamp(tileType, 0, MAX_TILE_TYPES - 1);
+	tileTypes[row * numCols + col] = tileType;
+
+	const uint64_t bit = uint64_t(1) << (col & 63);
+	uint64_t& word = solidBits[row * wordsPerRow + (col >> 6)];
+	const bool wasSolid = (word & bit) != 0;
+	if (tileProperties[tileType].isSolid) {
+		word |= bit;
+	} else {
+		word &= ~bit;
+	}
+	if (wasSolid != tileProperties[tileType].isSolid) {
+		version++;
+	}
+}
+
+int TileMap::GetTileType(int col, int row) const {
+	return tileTypes[row * numCols + col];
+}
+
+int TileMap::ToTile(float coordinate) const {
+	return static_cast<int>(std::floor(coordinate / tileSize));
+}
+
+bool TileMap::IsAreaSolid(int col0, int row0, int col1, int row1) const {
+	col0 = std::max(col0, 0);
+	row0 = std::max(row0, 0);
+	col1 = std::min(col1, numCols - 1);
+	row1 = std::min(row1, numRows - 1);
+	if (col0 > col1 || row0 > row1) {
+		return false;
+	}
+
+	const int word0 = col0 >> 6;
+	const int word1 = col1 >> 6;
+	for (int row = row0; row <= row1; row++) {
+		const uint64_t* bits = &solidBits[row * wordsPerRow];
+		for (int w = word0; w <= word1; w++) {
+			uint64_t mask = ~uint64_t(0);
+			if (w == word0) {
+				mask &= ~uint64_t(0) << (col0 & 63);
+			}
+			if (w == word1 && (col1 & 63) != 63) {
+				mask &= (uint64_t(1) << ((col1 & 63) + 1)) - 1;
+			}
+			if (bits[w] & mask) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
@@ -0,0 +1,74 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per tile type properties, indexed by the tile's two-digit type in the .map file
+struct TileProperties {
+	bool isSolid = false;
+};
+
+//*************************************************************************************
+// TILE MAP
+// Tile types of a level plus a bit-grid of solid tiles, one bit per tile and 64 tiles per
+// word. Collision code asks the grid directly instead of giving every tile a collider,
+// so a lookup costs the same on any map size.
+// The version changes whenever the solid tiles change, so caches built from the grid
+// can tell they are stale.
+//*************************************************************************************
+
+class TileMap {
+public:
+	static const int MAX_TILE_TYPES = 100;
+
+private:
+	int numCols = 0;
+	int numRows = 0;
+	float tileSize = 1.0f;		// world size of a tile
+
+	std::vector<int> tileTypes;	// [index = row * numCols + col]
+	std::vector<uint64_t> solidBits;
+	int wordsPerRow = 0;
+	unsigned int version = 0;
+
+	TileProperties tileProperties[MAX_TILE_TYPES];
+
+public:
+	TileMap() = default;
+
+	void SetTileProperties(int tileType, const TileProperties& properties);
+	const TileProperties& GetTileProperties(int tileType) const;
+
+	// Reads a comma separated .map file of two-digit tile types; returns false if the file could not be read
+	bool LoadFromFile(const std::string& filePath, int numCols, int numRows, float tileSize);
+
+	// Starts a map of the given size with every tile of type 0
+	void Create(int numCols, int numRows, float tileSize);
+	void Clear();
+
+	void SetTileType(int col, int row, int tileType);
+	int GetTileType(int col, int row) const;
+
+	int GetNumCols() const { return numCols; }
+	int GetNumRows() const { return numRows; }
+	float GetTileSize() const { return tileSize; }
+	unsigned int GetVersion() const { return version; }
+
+	// Tile containing a world coordinate
+	int ToTile(float coordinate) const;
+
+	// Tiles outside the map are open
+	bool IsSolid(int col, int row) const {
+		if (col < 0 || row < 0 || col >= numCols || row >= numRows) {
+			return false;
+		}
+		return (solidBits[row * wordsPerRow + (col >> 6)] >> (col & 63)) & 1;
+	}
+
+	// Whether any tile in the inclusive rectangle of tiles is solid, testing up to 64 tiles of a row at once
+	bool IsAreaSolid(int col0, int row0, int col1, int row1) const;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "TileRaycast.h"
+#include <cmath>
+#include <limits>
+
+// Rays per job: enough work to outweigh taking a batch off the shared counter
+static const size_t RAYCAST_BATCH_SIZE = 256;
+
+TileRayHit RaycastTiles(const TileMap& tileMap, const TileRay& ray) {
+	TileRayHit hit = { false, -1, -1, ray.maxDistance };
+
+	const float length = glm::length(ray.direction);
+	if (length == 0.0f || tileMap.GetNumCols() == 0) {
+		return hit;
+	}
+	const glm::vec2 direction = ray.direction / length;
+	const float tileSize = tileMap.GetTileSize();
+	const float infinity = std::numeric_limits<float>::infinity();
+	const int numCols = tileMap.GetNumCols();
+	const int numRows = tileMap.GetNumRows();
+
+	int col = tileMap.ToTile(ray.origin.x);
+	int row = tileMap.ToTile(ray.origin.y);
+
+	// Distance along the ray to the first vertical / horizontal tile border, and between two borders
+	const int stepCol = direction.x > 0.0f ? 1 : -1;
+	const int stepRow = direction.y > 0.0f ? 1 : -1;
+	float nextBorderX = infinity, nextBorderY = infinity;
+	float borderStepX = infinity, borderStepY = infinity;
+	if (direction.x != 0.0f) {
+		nextBorderX = ((col + (stepCol > 0 ? 1 : 0)) * tileSize - ray.origin.x) / direction.x;
+		borderStepX = tileSize / std::abs(direction.x);
+	}
+	if (direction.y != 0.0f) {
+		nextBorderY = ((row + (stepRow > 0 ? 1 : 0)) * tileSize - ray.origin.y) / direction.y;
+		borderStepY = tileSize / std::abs(direction.y);
+	}
+
+	float distance = 0.0f;
+	while (distance <= ray.maxDistance) {
+		if (tileMap.IsSolid(col, row)) {
+			hit.isHit = true;
+			hit.col = col;
+			hit.row = row;
+			hit.distance = distance;
+			return hit;
+		}
+
+		// Once the ray has left the map and is heading away from it, nothing more can be hit
+		if ((col < 0 && stepCol < 0) || (col >= numCols && stepCol > 0) || (row < 0 && stepRow < 0) || (row >= numRows && stepRow > 0)) {
+			break;
+		}
+
+		if (nextBorderX < nextBorderY) {
+			distance = nextBorderX;
+			nextBorderX += borderStepX;
+			col += stepCol;
+		} else {
+			distance = nextBorderY;
+			nextBorderY += borderStepY;
+			row += stepRow;
+		}
+	}
+	return hit;
+}
+
+void RaycastTilesBatch(const TileMap& tileMap, const TileRay* rays, TileRayHit* hits, size_t count, JobSystem& jobSystem) {
+	jobSystem.ParallelFor(count, RAYCAST_BATCH_SIZE, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			hits[i] = RaycastTiles(tileMap, rays[i]);
+		}
+	});
+}
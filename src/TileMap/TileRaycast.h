@@ -0,0 +1,36 @@
+#ifndef TILERAYCAST_H
+#define TILERAYCAST_H
+
+#include "TileMap.h"
+#include "../Jobs/JobSystem.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+
+struct TileRay {
+	glm::vec2 origin;
+	glm::vec2 direction;		// need not be normalized
+	float maxDistance;
+};
+
+struct TileRayHit {
+	bool isHit;
+	int col;					// solid tile the ray hit
+	int row;
+	float distance;				// world distance from the origin to the hit
+};
+
+//*************************************************************************************
+// TILE RAYCASTS
+// Ray casts against the solid tiles of a TileMap. The ray walks the grid one tile at a
+// time with a DDA (Amanatides & Woo): each step crosses whichever tile border, vertical
+// or horizontal, is nearer along the ray, so every tile the ray touches is tested
+// exactly once with a single bit lookup.
+// Line of sight between two points is a ray whose max distance is their distance.
+//*************************************************************************************
+
+TileRayHit RaycastTiles(const TileMap& tileMap, const TileRay& ray);
+
+// Casts count rays into hits[0..count), spread over the job system's threads
+void RaycastTilesBatch(const TileMap& tileMap, const TileRay* rays, TileRayHit* hits, size_t count, JobSystem& jobSystem);
+
+#endif